@@ -0,0 +1,176 @@
+#include <benchmark/benchmark.h>
+#include <sys/resource.h>
+#include <zmq.h>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "libsubtractive/actor.hpp"
+#include "libsubtractive/communication/zmq/zeromq_wrapper.hpp"
+
+namespace libsubtractive
+{
+// Minimal actor which replies to every message it receives
+class Echo final : Actor<Echo>
+{
+public:
+    Echo(const zmq::Context& zeromq, Endpoint endpoint)
+        : Actor(
+              zeromq,
+              [&]() -> auto {
+                  auto output = Sockets{};
+
+                  if (const auto* bind = std::get_if<std::string>(&endpoint)) {
+                      output.emplace_back(
+                          zeromq.Socket(ZMQ_PAIR, Direction::Bind, *bind));
+                  }
+
+                  return output;
+              },
+              nullptr,
+              take_pipes({&endpoint}))
+        , socket_(
+              std::holds_alternative<Pipe>(endpoint)
+                  ? Channel{pipes_.front()}
+                  : Channel{sockets_.front()})
+    {
+        init_actor();
+    }
+
+    ~Echo() { shutdown_actor(); }
+
+private:
+    friend Actor<Echo>;
+
+    const Channel socket_;
+
+    auto process_command(zmq::Message&& command) noexcept -> bool
+    {
+        socket_.send(std::move(command));
+
+        return false;
+    }
+};
+}  // namespace libsubtractive
+
+namespace
+{
+auto cpu_time() noexcept -> std::chrono::microseconds
+{
+    auto usage = rusage{};
+    getrusage(RUSAGE_SELF, &usage);
+    const auto total = [](const timeval& in) {
+        return std::chrono::seconds{in.tv_sec} +
+               std::chrono::microseconds{in.tv_usec};
+    };
+
+    return total(usage.ru_utime) + total(usage.ru_stime);
+}
+
+// CPU consumed by a set of actors which have nothing to do. Each machine costs
+// three actors (Machine, FlowControl, SerialConnection) so 12 machines is
+// state.range(0) == 36.
+void IdleActors(benchmark::State& state)
+{
+    using namespace libsubtractive;
+
+    const auto zeromq = zmq::Context{};
+    auto actors = std::vector<std::unique_ptr<Echo>>{};
+
+    for (auto i = std::int64_t{0}; i < state.range(0); ++i) {
+        actors.emplace_back(std::make_unique<Echo>(zeromq, RandomEndpoint()));
+    }
+
+    const auto start = cpu_time();
+
+    for (auto _ : state) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{100});
+    }
+
+    const auto used = cpu_time() - start;
+    state.counters["cpu_us_per_iteration"] = benchmark::Counter(
+        static_cast<double>(used.count()), benchmark::Counter::kAvgIterations);
+}
+
+// Round trip time for a message sent to an otherwise idle actor
+void WakeUpLatency(benchmark::State& state)
+{
+    using namespace libsubtractive;
+
+    const auto zeromq = zmq::Context{};
+    const auto endpoint = RandomEndpoint();
+    const auto echo = Echo{zeromq, endpoint};
+    const auto client = zeromq.Socket(ZMQ_PAIR, Direction::Connect, endpoint);
+    auto poll = zmq_pollitem_t{};
+    poll.socket = client;
+    poll.events = ZMQ_POLLIN;
+
+    for (auto _ : state) {
+        client.send(zeromq.Command(Command::GrblStatus));
+        zmq_poll(&poll, 1, -1);
+        auto reply = zmq::Message{};
+        client.receive(reply);
+        benchmark::DoNotOptimize(reply);
+    }
+}
+
+// One way latency of a link between two actors, measured as half the round
+// trip time of a message carrying a program line. state.range(0) selects a
+// ZMQ_PAIR socket (0) or a pipe (1).
+void HopLatency(benchmark::State& state)
+{
+    using namespace libsubtractive;
+
+    const auto zeromq = zmq::Context{};
+    const auto rings = (0 != state.range(0));
+    const auto endpoint = RandomEndpoint();
+    auto [client, server] = Pipe::Pair();
+    const auto echo = rings ? Echo{zeromq, std::move(server)}
+                            : Echo{zeromq, endpoint};
+    const auto socket = zeromq.Socket(
+        ZMQ_PAIR, Direction::Connect, rings ? RandomEndpoint() : endpoint);
+    const auto link = rings ? Channel{client} : Channel{socket};
+    auto poll = zmq_pollitem_t{};
+    poll.socket = rings ? nullptr : static_cast<void*>(socket);
+    poll.fd = rings ? client.fd() : 0;
+    poll.events = ZMQ_POLLIN;
+    const auto line = std::string{"G1 X10.125 Y-3.5 F1200\n"};
+    auto reply = zmq::Message{};
+
+    for (auto _ : state) {
+        auto message = zeromq.Command(Command::SendGcode);
+        message.emplace_back();
+        message.emplace_back(line.data(), line.size());
+        link.send(std::move(message));
+        reply = zmq::Message{};
+
+        if (rings) {
+            while (false == client.receive(reply)) {
+                zmq_poll(&poll, 1, -1);
+                client.clear();
+            }
+        } else {
+            zmq_poll(&poll, 1, -1);
+            socket.receive(reply);
+        }
+
+        benchmark::DoNotOptimize(reply);
+    }
+
+    // NOTE reported in seconds per hop
+    state.counters["hop"] = benchmark::Counter(
+        2.0 * static_cast<double>(state.iterations()),
+        benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+}  // namespace
+
+BENCHMARK(IdleActors)->Arg(4)->Arg(36)->Iterations(10)->UseRealTime();
+BENCHMARK(WakeUpLatency)->UseRealTime();
+BENCHMARK(HopLatency)->ArgName("rings")->Arg(0)->Arg(1)->UseRealTime();
+
+BENCHMARK_MAIN();
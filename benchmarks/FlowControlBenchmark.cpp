@@ -0,0 +1,76 @@
+#include <benchmark/benchmark.h>
+#include <zmq.h>
+#include <cstddef>
+#include <string>
+#include <utility>
+
+#include "libsubtractive/communication/flowcontrol.hpp"
+#include "libsubtractive/communication/zmq/zeromq_wrapper.hpp"
+
+namespace
+{
+constexpr auto BacklogLines = 1000;
+
+// Time from a feed hold request arriving at FlowControl until the '!' byte is
+// handed to the serial actor. The simulated device never acknowledges any
+// line so the receive buffer window stays full and a backlog of planned lines
+// remains in the incoming queue for the duration of the benchmark.
+void FeedHoldLatency(benchmark::State& state)
+{
+    using namespace libsubtractive;
+
+    const auto zeromq = zmq::Context{};
+    const auto flowEndpoint = RandomEndpoint();
+    const auto serialEndpoint = RandomEndpoint();
+    const auto machine =
+        zeromq.Socket(ZMQ_PAIR, Direction::Bind, flowEndpoint);
+    const auto options = libsubtractive_default_options();
+    const auto flow = FlowControl{
+        zeromq, nullptr, options, "benchmark", serialEndpoint, flowEndpoint};
+    const auto serial =
+        zeromq.Socket(ZMQ_PAIR, Direction::Connect, serialEndpoint);
+    auto poll = zmq_pollitem_t{};
+    poll.socket = serial;
+    poll.events = ZMQ_POLLIN;
+    const auto command = [&](const Command type, const std::string& text) {
+        auto message = zeromq.Command(type);
+        message.emplace_back();
+        message.emplace_back(text.data(), text.size());
+        machine.send(std::move(message));
+    };
+    const auto drain = [&]() {
+        auto count = std::size_t{0};
+
+        while (0 < zmq_poll(&poll, 1, 100)) {
+            auto message = zmq::Message{};
+            serial.receive(message);
+            ++count;
+        }
+
+        return count;
+    };
+
+    machine.send(zeromq.Command(Command::EnableFlowControl));
+
+    for (auto i = 0; i < BacklogLines; ++i) {
+        command(Command::SendGcode, "G1 X" + std::to_string(i) + " F100\n");
+    }
+
+    const auto saturated = drain();
+
+    for (auto _ : state) {
+        command(Command::GrblFeedHold, "!");
+        zmq_poll(&poll, 1, -1);
+        auto message = zmq::Message{};
+        serial.receive(message);
+        benchmark::DoNotOptimize(message);
+    }
+
+    state.counters["lines_in_flight"] =
+        benchmark::Counter(static_cast<double>(saturated));
+}
+}  // namespace
+
+BENCHMARK(FeedHoldLatency)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,239 @@
+#include <pthread.h>
+#include <signal.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "libsubtractive/libsubtractive.hpp"
+
+namespace
+{
+constexpr auto MaximumNumber = long{1} << 30;
+constexpr auto Usage = std::string_view{
+    "Usage: subtractived [options]\n"
+    "  --bind ENDPOINT        accept clients on ENDPOINT, such as\n"
+    "                         ipc:///run/subtractive or tcp://127.0.0.1:5555\n"
+    "  --hwm MESSAGES         messages queued for each client connection\n"
+    "  --keepalive SECONDS    probe silent TCP clients after SECONDS\n"
+    "  --serial ID=PATH[@BAUD]\n"
+    "                         connect the serial port PATH as machine ID\n"
+    "  --no-usb               do not search for USB devices\n"
+    "  --reactor-threads N    share N threads between machines\n"
+    "  --log-level LEVEL      off, error, warning, info or debug\n"
+    "  --log-file PATH        write binary log records to PATH\n"
+    "  --help                 show this message\n"};
+
+struct Arguments {
+    LS_options options_{libsubtractive_default_options()};
+    // NOTE options_ points into these, so they are not modified once parsed
+    std::vector<std::string> strings_{};
+    std::vector<const char*> endpoints_{};
+    std::vector<LS_serial_port> serial_ports_{};
+};
+
+auto parse_level(const std::string_view text, LS_LogLevel& out) noexcept
+    -> bool;
+auto parse_level(const std::string_view text, LS_LogLevel& out) noexcept
+    -> bool
+{
+    using Level = std::pair<std::string_view, LS_LogLevel>;
+    constexpr auto levels = std::array<Level, 5>{
+        {{"off", LS_LOG_OFF},
+         {"error", LS_LOG_ERROR},
+         {"warning", LS_LOG_WARNING},
+         {"info", LS_LOG_INFO},
+         {"debug", LS_LOG_DEBUG}}};
+
+    for (const auto& [name, level] : levels) {
+        if (name == text) {
+            out = level;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+auto parse_number(const char* text, int& out) noexcept -> bool;
+auto parse_number(const char* text, int& out) noexcept -> bool
+{
+    char* end{nullptr};
+    const auto value = std::strtol(text, &end, 10);
+
+    if ((end == text) || ('\0' != *end) || (0 > value) ||
+        (MaximumNumber < value)) {
+        return false;
+    }
+
+    out = static_cast<int>(value);
+
+    return true;
+}
+
+// Serial ports are given as ID=PATH or ID=PATH@BAUD
+auto parse_serial(const std::string& text, Arguments& out) -> bool;
+auto parse_serial(const std::string& text, Arguments& out) -> bool
+{
+    const auto equals = text.find('=');
+
+    if ((std::string::npos == equals) || (0 == equals)) { return false; }
+
+    const auto at = text.find('@', equals);
+    auto baud = int{0};
+
+    if (std::string::npos != at) {
+        if (false == parse_number(text.c_str() + at + 1u, baud)) {
+            return false;
+        }
+    }
+
+    const auto path = text.substr(equals + 1u, at - (equals + 1u));
+
+    if (path.empty()) { return false; }
+
+    out.strings_.emplace_back(text.substr(0, equals));
+    out.strings_.emplace_back(path);
+    out.serial_ports_.push_back(
+        {nullptr, nullptr, static_cast<std::uint32_t>(baud)});
+
+    return true;
+}
+
+auto parse(const int argc, char* argv[], Arguments& out) -> bool;
+auto parse(const int argc, char* argv[], Arguments& out) -> bool
+{
+    auto& options = out.options_;
+    // NOTE indices into strings_, which may reallocate until parsing is done
+    auto serial = std::vector<std::size_t>{};
+    auto endpoints = std::vector<std::size_t>{};
+    auto logFile = std::optional<std::size_t>{};
+
+    for (auto i = 1; i < argc; ++i) {
+        const auto name = std::string_view{argv[i]};
+
+        if ("--no-usb" == name) {
+            options.init_usb_ = false;
+
+            continue;
+        }
+
+        if (argc == i + 1) {
+            std::fprintf(stderr, "Missing value for %s\n", argv[i]);
+
+            return false;
+        }
+
+        const auto* value = argv[++i];
+        auto valid{true};
+
+        if ("--bind" == name) {
+            endpoints.emplace_back(out.strings_.size());
+            out.strings_.emplace_back(value);
+        } else if ("--hwm" == name) {
+            valid = parse_number(value, options.router_hwm_);
+        } else if ("--keepalive" == name) {
+            valid = parse_number(value, options.tcp_keepalive_s_);
+        } else if ("--serial" == name) {
+            serial.emplace_back(out.strings_.size());
+            valid = parse_serial(value, out);
+        } else if ("--reactor-threads" == name) {
+            auto threads = int{0};
+            valid = parse_number(value, threads);
+            options.reactor_threads_ = static_cast<unsigned>(threads);
+        } else if ("--log-level" == name) {
+            valid = parse_level(value, options.log_level_);
+        } else if ("--log-file" == name) {
+            logFile = out.strings_.size();
+            out.strings_.emplace_back(value);
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i - 1]);
+
+            return false;
+        }
+
+        if (false == valid) {
+            std::fprintf(stderr, "Invalid value for %s\n", argv[i - 1]);
+
+            return false;
+        }
+    }
+
+    // NOTE strings_ no longer grows, so pointers into it remain valid
+    if (logFile) { options.log_file_ = out.strings_.at(*logFile).c_str(); }
+
+    for (const auto index : endpoints) {
+        out.endpoints_.emplace_back(out.strings_.at(index).c_str());
+    }
+
+    for (auto i = std::size_t{0}; i < serial.size(); ++i) {
+        auto& port = out.serial_ports_.at(i);
+        port.id_ = out.strings_.at(serial.at(i)).c_str();
+        port.path_ = out.strings_.at(serial.at(i) + 1u).c_str();
+    }
+
+    options.endpoints_ = out.endpoints_.data();
+    options.endpoint_count_ = out.endpoints_.size();
+    options.serial_ports_ = out.serial_ports_.data();
+    options.serial_port_count_ = out.serial_ports_.size();
+
+    return true;
+}
+}  // namespace
+
+// Runs a context in a process of its own so clients in other processes, or on
+// other hosts, share its machines through ipc:// and tcp:// endpoints, and a
+// client which crashes can not take machine control with it
+int main(int argc, char* argv[])
+{
+    for (auto i = 1; i < argc; ++i) {
+        if (0 == std::strcmp(argv[i], "--help")) {
+            std::fputs(Usage.data(), stdout);
+
+            return EXIT_SUCCESS;
+        }
+    }
+
+    auto arguments = Arguments{};
+
+    if (false == parse(argc, argv, arguments)) {
+        std::fputs(Usage.data(), stderr);
+
+        return EXIT_FAILURE;
+    }
+
+    // NOTE blocked before the context starts so every thread it creates
+    // inherits the mask and only sigwait receives these signals
+    auto signals = sigset_t{};
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    try {
+        if (nullptr == libsubtractive_init_context(&arguments.options_)) {
+            throw std::runtime_error("no context");
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "Failed to start libsubtractive: %s\n", e.what());
+
+        return EXIT_FAILURE;
+    }
+
+    auto received = int{0};
+    sigwait(&signals, &received);
+    libsubtractive_close_context();
+
+    return EXIT_SUCCESS;
+}
@@ -1,6 +1,9 @@
 #ifndef LIBSUBTRACTIVE_LIBSUBTRACTIVE_HPP
 #define LIBSUBTRACTIVE_LIBSUBTRACTIVE_HPP
 
+#include <cstddef>
+#include <cstdint>
+
 extern "C" {
 enum LS_Options {
     LS_LISTDEVICES = 1,
@@ -22,6 +25,13 @@ enum LS_Options {
     LS_GRBLCYCLETOGGLE = 17,
     LS_GRBLFEEDHOLD = 18,
     LS_GRBLJOGCANCEL = 19,
+    LS_ANALYZE_PROGRAM = 20,
+    LS_RESUME_PROGRAM = 21,
+    LS_SUBSCRIBE_EVENTS = 22,
+    LS_EVENTSDROPPED = 119,
+    LS_PROGRAMANALYSIS = 120,
+    LS_STATUSREPORT = 121,
+    LS_PROGRAMPROGRESS = 122,
     LS_RESPONSERECEIVED = 123,
     LS_NOWEXECUTING = 124,
     LS_DEVICEREMOVED = 125,
@@ -37,13 +47,230 @@ enum LS_Options {
     Shutdown = 255
 };
 
+enum LS_LogLevel {
+    LS_LOG_OFF = 0,
+    LS_LOG_ERROR = 1,
+    LS_LOG_WARNING = 2,
+    LS_LOG_INFO = 3,
+    LS_LOG_DEBUG = 4,
+};
+
+// LS_SUBSCRIBE_EVENTS takes a machine ID and a std::uint32_t combination of
+// these bits. Only the selected pushes are sent to the subscriber and a mask of
+// 0 unsubscribes. LS_SUBSCRIBE, and sending any command to a machine without
+// having subscribed, selects LS_EVENT_ALL.
+enum LS_Event {
+    // LS_RESPONSERECEIVED
+    LS_EVENT_RESPONSES = 1 << 0,
+    // Messages the machine sent without being asked, other than alarms
+    LS_EVENT_PUSHES = 1 << 1,
+    // LS_STATUSREPORT
+    LS_EVENT_STATUS = 1 << 2,
+    // Pushes of ALARM lines
+    LS_EVENT_ALARMS = 1 << 3,
+    // LS_PROGRAMPROGRESS
+    LS_EVENT_PROGRESS = 1 << 4,
+    LS_EVENT_ALL = (1 << 5) - 1,
+};
+
+enum LS_ProgramState {
+    LS_PROGRAM_RUNNING = 1,
+    LS_PROGRAM_COMPLETE = 2,
+    LS_PROGRAM_ABORTED = 3,
+    LS_PROGRAM_FAILED = 4,
+};
+
+// Payload of LS_PROGRAMPROGRESS pushes. LS_EXECUTE_PROGRAM takes the machine
+// ID, a file path and a program buffer. The buffer is used when the path is
+// empty. LS_RESUME_PROGRAM takes the same arguments followed by the 1-based
+// number of the first line to execute as a std::uint64_t. The modal state,
+// tool, spindle and coolant left by the preceding lines are restored and the
+// tool is moved to where those lines left it, by way of the highest Z they
+// used, before streaming continues from that line.
+struct LS_program_progress {
+    std::uint64_t lines_read_;
+    std::uint64_t lines_sent_;
+    std::uint64_t lines_acknowledged_;
+    std::uint64_t errors_;
+    std::uint64_t state_;
+    // Program bytes consumed and bytes transmitted for them, which differ
+    // when G-code compaction is enabled
+    std::uint64_t bytes_read_;
+    std::uint64_t bytes_sent_;
+};
+
+// Reply to LS_ANALYZE_PROGRAM, which takes a machine ID, a file path and a
+// program buffer like LS_EXECUTE_PROGRAM. The duration is estimated from the
+// maximum rate and acceleration settings ($110-$112, $120-$122) last reported
+// by the machine, or Grbl's defaults when the machine ID is empty. Distances
+// and the bounding box of the X, Y and Z axes are in millimetres, durations in
+// seconds and feed rates in millimetres per minute.
+struct LS_program_analysis {
+    // LS_PROGRAM_COMPLETE, or LS_PROGRAM_FAILED if the program could not be
+    // read
+    std::uint64_t state_;
+    std::uint64_t lines_;
+    std::uint64_t moves_;
+    std::uint64_t arcs_;
+    // Lines which are not G-code, such as $ commands, or could not be lexed
+    std::uint64_t skipped_;
+    double duration_;
+    double rapid_distance_;
+    double feed_distance_;
+    double min_[3];
+    double max_[3];
+    double feed_min_;
+    double feed_max_;
+    // Weighted by the distance moved at each feed rate
+    double feed_mean_;
+};
+
+enum LS_MachineState {
+    LS_STATE_UNKNOWN = 0,
+    LS_STATE_IDLE = 1,
+    LS_STATE_RUN = 2,
+    LS_STATE_HOLD = 3,
+    LS_STATE_JOG = 4,
+    LS_STATE_ALARM = 5,
+    LS_STATE_DOOR = 6,
+    LS_STATE_CHECK = 7,
+    LS_STATE_HOME = 8,
+    LS_STATE_SLEEP = 9,
+    LS_STATE_TOOL = 10,
+};
+
+// Bits of LS_status_report::fields_ which indicate valid members
+enum LS_StatusField {
+    LS_STATUS_MPOS = 1 << 0,
+    LS_STATUS_WPOS = 1 << 1,
+    LS_STATUS_WCO = 1 << 2,
+    LS_STATUS_FEED = 1 << 3,
+    LS_STATUS_SPINDLE = 1 << 4,
+    LS_STATUS_OVERRIDES = 1 << 5,
+    LS_STATUS_BUFFER = 1 << 6,
+    LS_STATUS_PINS = 1 << 7,
+    LS_STATUS_LINE = 1 << 8,
+};
+
+// Bits of LS_status_report::pins_
+enum LS_Pin {
+    LS_PIN_X = 1 << 0,
+    LS_PIN_Y = 1 << 1,
+    LS_PIN_Z = 1 << 2,
+    LS_PIN_A = 1 << 3,
+    LS_PIN_B = 1 << 4,
+    LS_PIN_C = 1 << 5,
+    LS_PIN_PROBE = 1 << 6,
+    LS_PIN_DOOR = 1 << 7,
+    LS_PIN_HOLD = 1 << 8,
+    LS_PIN_RESET = 1 << 9,
+    LS_PIN_START = 1 << 10,
+};
+
+enum { LS_MAX_AXES = 6 };
+
+// Payload of LS_STATUSREPORT pushes. Grbl sends either MPos or WPos and only
+// occasionally sends WCO and Ov, so the most recent work offset and overrides
+// are retained and used to fill in whichever position was not reported.
+struct LS_status_report {
+    std::uint32_t state_;
+    std::uint32_t substate_;
+    std::uint32_t fields_;
+    std::uint32_t axes_;
+    double machine_position_[LS_MAX_AXES];
+    double work_position_[LS_MAX_AXES];
+    double work_offset_[LS_MAX_AXES];
+    double feed_;
+    double spindle_;
+    std::uint32_t override_feed_;
+    std::uint32_t override_rapid_;
+    std::uint32_t override_spindle_;
+    std::uint32_t planner_available_;
+    std::uint32_t rx_available_;
+    std::uint32_t pins_;
+    std::uint32_t line_;
+    std::uint32_t reserved_;
+};
+
+// Serial port connected without USB enumeration, for ports which are not USB
+// devices or have no serial number
+struct LS_serial_port {
+    // Machine ID used by every other command, like a USB serial number
+    const char* id_;
+    // Device path such as /dev/ttyAMA0
+    const char* path_;
+    // 0 uses 115200
+    std::uint32_t baud_rate_;
+};
+
 struct LS_options {
     bool init_usb_;
+    // 0 = one thread per actor, otherwise the number of shared reactor threads
+    unsigned int reactor_threads_;
+    // Interval between status requests sent by the library while a machine is
+    // moving or has queued lines. 0 disables status polling.
+    unsigned int status_interval_active_ms_;
+    // Interval between status requests while a machine is idle. 0 uses the
+    // active interval.
+    unsigned int status_interval_idle_ms_;
+    // Compact G-code sent with LS_SENDGCODE and LS_EXECUTE_PROGRAM by removing
+    // comments, whitespace and repeated modal words
+    bool compact_gcode_;
+    // Digits kept after the decimal point of coordinates by G-code compaction.
+    // Negative values keep every digit.
+    int compact_precision_;
+    // Maximum deviation, in program units, allowed when LS_EXECUTE_PROGRAM
+    // merges runs of short G1 moves into single lines and XY plane arcs.
+    // 0 disables path optimization.
+    double path_tolerance_;
+    // Threads used by LS_ANALYZE_PROGRAM. 0 uses one per hardware thread.
+    unsigned int analyzer_threads_;
+    // Directory holding preprocessed copies of programs run to completion
+    // with LS_EXECUTE_PROGRAM, so repeat runs stream without being compacted
+    // and optimized again. Must remain valid until the context is closed.
+    // NULL or an empty string disables the cache.
+    const char* program_cache_dir_;
+    // Total size of the program cache in bytes above which the least recently
+    // used programs are removed. 0 disables eviction.
+    std::uint64_t program_cache_size_;
+    // Connect the Machine, FlowControl and serial port actors of each device
+    // with lock-free in-process rings instead of ZMQ_PAIR sockets
+    bool ring_transport_;
+    // Messages less severe than this are discarded before they are formatted.
+    // LS_LOG_DEBUG includes every line received from a machine.
+    LS_LogLevel log_level_;
+    // File which receives log records in a compact binary form, described in
+    // src/libsubtractive/log.hpp, instead of text on standard output. NULL or
+    // an empty string writes text.
+    const char* log_file_;
+    // Serial ports connected as soon as the context starts, whether or not
+    // init_usb_ is set. Only read by libsubtractive_init_context.
+    const LS_serial_port* serial_ports_;
+    std::size_t serial_port_count_;
+    // Responses and pushes held for a subscriber which is not reading them.
+    // Further messages are discarded and replaced by one LS_EVENTSDROPPED
+    // push holding their number as a std::uint64_t. Status reports and program
+    // progress are not counted since only the latest of each is held.
+    std::size_t subscriber_queue_limit_;
+    // Endpoints such as ipc:///run/subtractive or tcp://127.0.0.1:5555 on
+    // which the context also accepts clients from other processes, in addition
+    // to libsubtractive_endpoint(). Only read by libsubtractive_init_context.
+    const char* const* endpoints_;
+    std::size_t endpoint_count_;
+    // Messages queued in each direction for every client connection. 0 uses
+    // the ZeroMQ default.
+    int router_hwm_;
+    // Seconds a TCP client may be silent before keepalive probes are sent at
+    // the same interval. Clients which miss three probes are disconnected.
+    // 0 disables keepalive.
+    int tcp_keepalive_s_;
 };
 
 LS_options libsubtractive_default_options();
 const char* libsubtractive_endpoint();
 void* libsubtractive_init_context(const LS_options* options);
 void libsubtractive_close_context();
+// Changes the level set by LS_options::log_level_ while the context runs
+void libsubtractive_set_log_level(LS_LogLevel level);
 }
 #endif  // LIBSUBTRACTIVE_LIBSUBTRACTIVE_HPP
@@ -3,29 +3,37 @@
 #include <zmq.h>
 #include <atomic>
 #include <cassert>
+#include <chrono>
 #include <functional>
-#include <iostream>
 #include <map>
+#include <optional>
 #include <string>
 #include <thread>
 #include <utility>
 #include <vector>
 
+#include "libsubtractive/communication/pipe.hpp"
 #include "libsubtractive/communication/zmq/zeromq_wrapper.hpp"
+#include "libsubtractive/log.hpp"
+#include "libsubtractive/reactor.hpp"
 
 namespace libsubtractive
 {
 template <typename CRTP>
-class Actor
+class Actor : private Reactor::Client
 {
 protected:
     using Sockets = std::vector<zmq::Socket>;
     // NOTE SocketInit is necessary because c++ doesn't support movable
     // initialization lists, and zmq::Sockets are a move-only type
     using SocketInit = std::function<Sockets()>;
+    using Pipes = std::vector<Pipe>;
+    using Clock = Reactor::Clock;
 
     const zmq::Context& zeromq_;
+    Reactor* const reactor_;
     Sockets sockets_;
+    Pipes pipes_;
     const bool enabled_;
     std::vector<zmq_pollitem_t> new_poll_items_;
 
@@ -36,7 +44,13 @@ protected:
         const auto previous = running_.exchange(true);
 
         if (false == previous) {
-            zmq_thread_ = std::thread{[this] { zmq_thread(); }};
+            init_poll_items();
+
+            if (nullptr == reactor_) {
+                zmq_thread_ = std::thread{[this] { zmq_thread(); }};
+            } else {
+                reactor_->add(*this);
+            }
         }
     }
 
@@ -44,76 +58,242 @@ protected:
     {
         running_ = false;
 
-        if (zmq_thread_.joinable()) { zmq_thread_.join(); }
+        if (nullptr == reactor_) {
+            wake_actor();
+
+            if (zmq_thread_.joinable()) { zmq_thread_.join(); }
+        } else if (enabled_) {
+            reactor_->remove(*this);
+        }
+    }
+    // NOTE the actor thread blocks in zmq_poll until a socket is readable so
+    // any state change made from outside that thread must be followed by a
+    // call to wake_actor(). Items added to new_poll_items_ from inside
+    // process_command are picked up before the next poll without a wake up.
+    auto wake_actor() const noexcept -> void
+    {
+        if (wake_push_.has_value()) {
+            zmq_send(*wake_push_, nullptr, 0, ZMQ_DONTWAIT);
+        }
+    }
+
+    // Default for actors which process every message received on any socket
+    auto accept_command(const void*, const zmq::Message&) const noexcept
+        -> bool
+    {
+        return true;
     }
+    // Default for actors which never call set_timer()
+    auto process_timer() noexcept -> void {}
+    // Schedules one call to process_timer() at or after deadline, replacing
+    // any earlier schedule. Only call from process_command or process_timer.
+    auto set_timer(const Clock::time_point deadline) noexcept -> void
+    {
+        deadline_ = deadline;
+    }
+    auto timer() const noexcept -> Clock::time_point { return deadline_; }
 
-    Actor(const zmq::Context& zeromq, SocketInit sockets)
+    Actor(
+        const zmq::Context& zeromq,
+        SocketInit sockets,
+        Reactor* reactor = nullptr,
+        Pipes pipes = {})
         : zeromq_(zeromq)
+        , reactor_(reactor)
         , sockets_(sockets())
-        , enabled_(0 < sockets_.size())
+        , pipes_(std::move(pipes))
+        , enabled_((0 < sockets_.size()) || (0 < pipes_.size()))
         , new_poll_items_()
         , poll_items_()
         , running_(false)
+        , deadline_(Clock::time_point::max())
+        , wake_endpoint_((nullptr == reactor_) ? RandomEndpoint() : "")
+        , wake_pull_(wake_socket(ZMQ_PULL, Direction::Bind))
+        , wake_push_(wake_socket(ZMQ_PUSH, Direction::Connect))
         , zmq_thread_()
     {
     }
     virtual ~Actor() { shutdown_actor(); }
 
 private:
+    // Messages taken from a pipe per poll, so a busy peer can not starve the
+    // other sockets of the actor
+    static constexpr auto PipeBatch = std::size_t{64};
+
     std::vector<zmq_pollitem_t> poll_items_;
     std::atomic_bool running_;
+    Clock::time_point deadline_;
+    // NOTE only actors with their own thread have a wake up socket pair,
+    // since the reactor wakes up every actor it runs
+    const std::string wake_endpoint_;
+    const std::optional<zmq::Socket> wake_pull_;
+    const std::optional<zmq::Socket> wake_push_;
     std::thread zmq_thread_;
 
     auto child() noexcept -> CRTP& { return static_cast<CRTP&>(*this); }
+    auto expire_timer() noexcept -> void
+    {
+        if (Clock::now() < deadline_) { return; }
 
-    auto zmq_thread() noexcept -> void
+        deadline_ = Clock::time_point::max();
+        child().process_timer();
+    }
+
+    auto init_poll_items() noexcept -> void
     {
         assert(0 == poll_items_.size());
 
+        // NOTE when running on a reactor thread the reactor has its own wake
+        // up socket
+        if (wake_pull_.has_value()) {
+            auto& wake = poll_items_.emplace_back();
+            wake.socket = *wake_pull_;
+            wake.events = ZMQ_POLLIN;
+        }
+
         for (auto& socket : sockets_) {
             auto& item = poll_items_.emplace_back();
             item.socket = socket;
             item.events = ZMQ_POLLIN;
         }
 
-        assert(sockets_.size() == poll_items_.size());
+        for (const auto& pipe : pipes_) {
+            auto& item = poll_items_.emplace_back();
+            item.socket = nullptr;
+            item.fd = pipe.fd();
+            item.events = ZMQ_POLLIN;
+        }
+
+        // NOTE sockets added by the child before the actor started
+        for (auto& item : new_poll_items_) {
+            poll_items_.emplace_back(std::move(item));
+        }
 
-        while (running_) {
-            const auto events = zmq_poll(
-                poll_items_.data(), static_cast<int>(poll_items_.size()), 1);
+        new_poll_items_.clear();
+    }
+    // Returns true if the actor should stop
+    auto process_pipe(const int fd) noexcept -> bool
+    {
+        auto disconnectAfter{false};
 
-            if (0 > events) {
-                const auto error = zmq_errno();
-                std::cerr << zmq_strerror(error) << '\n';
+        for (const auto& pipe : pipes_) {
+            if (fd != pipe.fd()) { continue; }
 
-                continue;
-            } else if (0 == events) {
-                continue;
+            pipe.clear();
+            auto count = std::size_t{0};
+            auto message = zmq::Message{};
+
+            for (; (PipeBatch > count) && pipe.receive(message); ++count) {
+                disconnectAfter |= child().process_command(std::move(message));
+                message = zmq::Message{};
             }
 
-            auto disconnectAfter{false};
+            if (PipeBatch == count) { pipe.wake(); }
+        }
+
+        return disconnectAfter;
+    }
+    // Returns true if the actor should stop
+    auto process_poll_items() noexcept -> bool
+    {
+        auto disconnectAfter{false};
+
+        for (auto& item : poll_items_) {
+            if (ZMQ_POLLIN != item.revents) { continue; }
 
-            for (auto& item : poll_items_) {
-                if (ZMQ_POLLIN == item.revents) {
-                    auto message = zmq::Message{};
+            if (nullptr == item.socket) {
+                disconnectAfter |= process_pipe(item.fd);
 
-                    if (zmq::Socket::receive(message, item)) {
-                        disconnectAfter |=
-                            child().process_command(std::move(message));
-                    }
+                continue;
+            }
+
+            if (wake_pull_.has_value() &&
+                (static_cast<void*>(*wake_pull_) == item.socket)) {
+                while (0 <= zmq_recv(item.socket, nullptr, 0, ZMQ_DONTWAIT)) {
+                    ;
                 }
+
+                continue;
             }
 
-            poll_items_.reserve(poll_items_.size() + new_poll_items_.size());
+            auto message = zmq::Message{};
 
-            for (auto& item : new_poll_items_) {
-                poll_items_.emplace_back(std::move(item));
+            if (zmq::Socket::receive(message, item) &&
+                child().accept_command(item.socket, message)) {
+                disconnectAfter |= child().process_command(std::move(message));
             }
+        }
+
+        poll_items_.reserve(poll_items_.size() + new_poll_items_.size());
+
+        for (auto& item : new_poll_items_) {
+            poll_items_.emplace_back(std::move(item));
+        }
+
+        new_poll_items_.clear();
+
+        return disconnectAfter;
+    }
+    auto reactor_deadline() const noexcept -> Clock::time_point final
+    {
+        return running_ ? deadline_ : Clock::time_point::max();
+    }
+    auto reactor_dispatch() noexcept -> bool final
+    {
+        if (false == running_) { return true; }
 
-            new_poll_items_.clear();
+        if (process_poll_items()) {
+            running_ = false;
 
-            if (disconnectAfter) { running_ = false; }
+            return true;
         }
+
+        return false;
+    }
+    auto reactor_expire() noexcept -> void final
+    {
+        if (running_) { expire_timer(); }
+    }
+    auto reactor_items() noexcept -> std::vector<zmq_pollitem_t>& final
+    {
+        return poll_items_;
     }
+    auto wake_socket(const int type, const Direction direction) const
+        -> std::optional<zmq::Socket>
+    {
+        if (wake_endpoint_.empty()) { return std::nullopt; }
+
+        return zeromq_.Socket(type, direction, wake_endpoint_);
+    }
+    auto zmq_thread() noexcept -> void
+    {
+        while (running_) {
+            const auto events = zmq_poll(
+                poll_items_.data(),
+                static_cast<int>(poll_items_.size()),
+                Reactor::poll_timeout(deadline_));
+
+            if (0 > events) {
+                const auto error = zmq_errno();
+                log::error(zmq_strerror(error));
+
+                continue;
+            }
+
+            if ((0 < events) && process_poll_items()) {
+                running_ = false;
+
+                continue;
+            }
+
+            expire_timer();
+        }
+    }
+
+    Actor() = delete;
+    Actor(const Actor&) = delete;
+    Actor(Actor&&) = delete;
+    auto operator=(const Actor&) -> Actor& = delete;
+    auto operator=(Actor&&) -> Actor& = delete;
 };
 }  // namespace libsubtractive
@@ -0,0 +1,124 @@
+#include "libsubtractive/analysis.hpp"  // IWYU pragma: associated
+
+#include <zmq.h>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "libsubtractive/gcode/analyzer.hpp"
+#include "libsubtractive/gcode/program.hpp"
+#include "libsubtractive/log.hpp"
+
+namespace libsubtractive
+{
+Analysis::Analysis(
+    const zmq::Context& zeromq,
+    const LS_options& options,
+    const std::string_view endpoint)
+    : Actor(zeromq, [&]() -> auto {
+        auto output = Sockets{};
+        output.emplace_back(
+            zeromq.Socket(ZMQ_PAIR, Direction::Connect, endpoint));
+
+        return output;
+    })
+    , parent_socket_(sockets_.at(0))
+    , threads_(options.analyzer_threads_)
+{
+    init_actor();
+}
+
+// Arguments are the machine ID, file path and program buffer of the request
+// followed by the motion limits of the machine
+auto Analysis::command_analyze_program(zmq::Message&& in) noexcept -> void
+{
+    if (4 > in.arg_count()) { abort(); }
+
+    auto limits = gcode::Limits{};
+    const auto& frame = in.arg(3);
+
+    if (sizeof(limits) == frame.size()) {
+        limits = frame.as<gcode::Limits>();
+    } else {
+        log::warning("Invalid limits, using defaults");
+    }
+
+    const auto path = in.arg(1).str();
+    const auto program = (0 == path.size())
+                             ? gcode::Program::Buffer(zmq::Frame{in.arg(2)})
+                             : gcode::Program::Map(std::string{path});
+    auto result = LS_program_analysis{};
+    result.state_ = LS_PROGRAM_FAILED;
+
+    if (program) {
+        const auto analyze = gcode::Analyzer{limits, threads_};
+        result = analyze(program->text());
+    }
+
+    auto reply = zeromq_.Response(in);
+    reply.emplace_back();
+    reply.emplace_back(Command::ProgramAnalysis);
+    reply.emplace_back(in.arg(0));
+    reply.emplace_back(result);
+    parent_socket_.send(std::move(reply));
+}
+
+auto Analysis::process_command(zmq::Message&& command) noexcept -> bool
+{
+    auto disconnectAfter{false};
+
+    switch (command.type()) {
+        case Command::Shutdown: {
+            disconnectAfter = true;
+        } break;
+        case Command::AnalyzeProgram: {
+            command_analyze_program(std::move(command));
+        } break;
+        case Command::Invalid:
+        case Command::ListDevices:
+        case Command::Subscribe:
+        case Command::SubscribeEvents:
+        case Command::Unsubscribe:
+        case Command::SendGcode:
+        case Command::ExecuteProgram:
+        case Command::ResumeProgram:
+        case Command::GrblHelp:
+        case Command::GrblStatus:
+        case Command::GrblSettings:
+        case Command::GrblVersion:
+        case Command::GrblHome:
+        case Command::GrblParams:
+        case Command::GrblParserState:
+        case Command::GrblStartupBlocks:
+        case Command::GrblCheckModeToggle:
+        case Command::GrblResetAlarm:
+        case Command::GrblSoftReset:
+        case Command::GrblCycleToggle:
+        case Command::GrblFeedHold:
+        case Command::GrblJogCancel:
+        case Command::EventsDropped:
+        case Command::ProgramAnalysis:
+        case Command::StatusReport:
+        case Command::ProgramProgress:
+        case Command::PushDeviceRemoved:
+        case Command::PushDeviceAdded:
+        case Command::ListDevicesReply:
+        case Command::ResponseReceived:
+        case Command::GrblPushReceived:
+        case Command::DeviceIsSupported:
+        case Command::EnableFlowControl:
+        case Command::DataReceived:
+        case Command::InitGrbl:
+        case Command::USBDeviceRemoved:
+        case Command::USBDeviceAdded:
+        default: {
+            abort();
+        }
+    }
+
+    return disconnectAfter;
+}
+
+Analysis::~Analysis() { shutdown_actor(); }
+}  // namespace libsubtractive
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string_view>
+
+#include "libsubtractive/actor.hpp"
+#include "libsubtractive/communication/zmq/zeromq_wrapper.hpp"  // IWYU pragma: keep
+#include "libsubtractive/libsubtractive.hpp"
+
+namespace libsubtractive
+{
+// Runs LS_ANALYZE_PROGRAM requests on a thread of its own, never on a reactor
+// thread, since analyzing a large program takes far longer than any other
+// command and would stall every actor sharing the reactor
+class Analysis final : Actor<Analysis>
+{
+public:
+    Analysis(
+        const zmq::Context& zeromq,
+        const LS_options& options,
+        const std::string_view endpoint);
+
+    ~Analysis();
+
+private:
+    friend Actor<Analysis>;
+
+    const zmq::Socket& parent_socket_;
+    const unsigned threads_;
+
+    auto command_analyze_program(zmq::Message&& in) noexcept -> void;
+    auto process_command(zmq::Message&& command) noexcept -> bool;
+
+    Analysis() = delete;
+    Analysis(const Analysis&) = delete;
+    Analysis(Analysis&&) = delete;
+    auto operator=(const Analysis&) -> Analysis& = delete;
+    auto operator=(Analysis&&) -> Analysis& = delete;
+};
+}  // namespace libsubtractive
@@ -2,14 +2,21 @@
 
 #include <boost/container/flat_map.hpp>
 #include <zmq.h>
+#include <algorithm>
 #include <cassert>
+#include <cctype>
+#include <charconv>
 #include <cstring>
 #include <regex>
 #include <type_traits>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #include "libsubtractive/communication/zmq/zeromq_wrapper.hpp"
+#include "libsubtractive/gcode/program.hpp"
+#include "libsubtractive/log.hpp"
+#include "libsubtractive/protocol/Status.hpp"
 
 namespace libsubtractive
 {
@@ -21,6 +28,17 @@ constexpr auto StatusPrefix{"<"};
 constexpr auto StatusSuffix{">"};
 constexpr auto ResponseGood{"ok"};
 constexpr auto ResponseBad{"error:"};
+constexpr auto OptionPrefix{"[OPT:"};
+// Receive buffer size of an unmodified Grbl build
+constexpr auto DefaultReceiveBuffer = std::size_t{128};
+// Maximum number of program lines waiting in the incoming queue
+constexpr auto ProgramReadAhead = std::size_t{256};
+// Initial number of slots in the incoming and outgoing queues, which only grow
+// if commands arrive faster than the device accepts them
+constexpr auto QueueSlots = 2u * ProgramReadAhead;
+constexpr auto ProgramReportInterval = std::chrono::milliseconds{250};
+// A status request which is not answered within this time is abandoned
+constexpr auto StatusTimeout = std::chrono::seconds{2};
 
 constexpr auto ends_with(
     const std::string_view text,
@@ -36,6 +54,47 @@ constexpr auto ends_with(
 
     return 0 == std::memcmp(it, suffix.data(), suffix.size());
 }
+auto is_moving(const std::uint32_t state) noexcept -> bool;
+auto is_moving(const std::uint32_t state) noexcept -> bool
+{
+    switch (state) {
+        case LS_STATE_RUN:
+        case LS_STATE_HOLD:
+        case LS_STATE_JOG:
+        case LS_STATE_HOME: {
+            return true;
+        }
+        default: {
+            return false;
+        }
+    }
+}
+auto is_space(const char c) noexcept -> bool;
+auto is_space(const char c) noexcept -> bool
+{
+    return 0 != std::isspace(static_cast<unsigned char>(c));
+}
+// Parses "<a>,<b>" at the start of text, ignoring anything after b
+auto parse_pair(
+    const std::string_view text,
+    std::size_t& first,
+    std::size_t& second) noexcept -> bool;
+auto parse_pair(
+    const std::string_view text,
+    std::size_t& first,
+    std::size_t& second) noexcept -> bool
+{
+    const auto* const end = text.data() + text.size();
+    const auto [comma, error1] = std::from_chars(text.data(), end, first);
+
+    if ((std::errc{} != error1) || (end == comma) || (',' != *comma)) {
+        return false;
+    }
+
+    const auto [next, error2] = std::from_chars(comma + 1, end, second);
+
+    return std::errc{} == error2;
+}
 constexpr auto starts_with(
     const std::string_view text,
     const std::string_view prefix) noexcept -> bool
@@ -54,6 +113,13 @@ auto FlowControl::Classifier::dump(zmq::Message& out) noexcept -> void
     buffer_.clear();
 }
 
+auto FlowControl::Classifier::failed() const noexcept -> bool
+{
+    if (buffer_.empty()) { return false; }
+
+    return starts_with(buffer_.back(), ResponseBad);
+}
+
 auto FlowControl::Classifier::operator()(const std::string_view line) noexcept
     -> Type
 {
@@ -94,7 +160,7 @@ auto FlowControl::Classifier::operator()(const std::string_view line) noexcept
         buffer_.clear();
         buffer_.emplace_back(line);
 
-        return Type::Startup;
+        return Type::Status;
     }
 
     if (starts_with(line, ResponseGood) || starts_with(line, ResponseBad)) {
@@ -183,42 +249,76 @@ auto FlowControl::Classifier::version() const noexcept -> grbl::VersionData
 
 FlowControl::FlowControl(
     const zmq::Context& zeromq,
+    Reactor* reactor,
+    const LS_options& options,
     const std::string_view serialNumber,
-    const std::string serialEndpoint,
-    const std::string flowEndpoint)
+    Endpoint serialEndpoint,
+    Endpoint flowEndpoint)
     : Actor(
           zeromq,
           [&]() -> auto {
               auto output = Sockets{};
-              output.emplace_back(
-                  zeromq_.Socket(ZMQ_PAIR, Direction::Connect, flowEndpoint));
-              output.emplace_back(
-                  zeromq_.Socket(ZMQ_PAIR, Direction::Bind, serialEndpoint));
+
+              if (const auto* flow = std::get_if<std::string>(&flowEndpoint)) {
+                  output.emplace_back(
+                      zeromq_.Socket(ZMQ_PAIR, Direction::Connect, *flow));
+              }
+
+              if (const auto* serial =
+                      std::get_if<std::string>(&serialEndpoint)) {
+                  output.emplace_back(
+                      zeromq_.Socket(ZMQ_PAIR, Direction::Bind, *serial));
+              }
 
               return output;
-          })
+          },
+          reactor,
+          take_pipes({&flowEndpoint, &serialEndpoint}))
     , usb_id_(serialNumber)
-    , limit_(127)
-    , parent_socket_(sockets_.at(0))
-    , serial_socket_(sockets_.at(1))
+    , limit_(DefaultReceiveBuffer - 1u)
+    , planner_()
+    // NOTE the parent link is created first with either transport
+    , parent_socket_(
+          std::holds_alternative<Pipe>(flowEndpoint)
+              ? Channel{pipes_.front()}
+              : Channel{sockets_.front()})
+    , serial_socket_(
+          std::holds_alternative<Pipe>(serialEndpoint)
+              ? Channel{pipes_.back()}
+              : Channel{sockets_.back()})
     , parse_()
     , active_(false)
     , alarm_(false)
-    , incoming_()
-    , outgoing_()
-    , realtime_(std::nullopt)
+    , incoming_(QueueSlots, limit_)
+    , outgoing_(QueueSlots, limit_)
+    , realtime_(1u, limit_)
     , used_()
+    , stream_()
+    , status_()
+    , status_active_(options.status_interval_active_ms_)
+    , status_idle_(
+          (0 < options.status_interval_idle_ms_)
+              ? options.status_interval_idle_ms_
+              : options.status_interval_active_ms_)
+    , status_sent_()
+    , compact_(
+          options.compact_gcode_
+              ? std::make_optional<gcode::Compactor>(options.compact_precision_)
+              : std::nullopt)
+    , compacted_()
+    , path_tolerance_(options.path_tolerance_)
+    , cache_(
+          ((nullptr == options.program_cache_dir_) ||
+           (0 == std::strlen(options.program_cache_dir_)))
+              ? std::nullopt
+              : std::make_optional<gcode::Cache>(
+                    options.program_cache_dir_, options.program_cache_size_))
+    , resume_()
+    , resume_text_()
 {
     init_actor();
 }
 
-auto FlowControl::buffer(const std::string_view bytes) -> std::vector<std::byte>
-{
-    const auto it = reinterpret_cast<const std::byte*>(bytes.data());
-
-    return std::vector<std::byte>{it, it + bytes.size()};
-}
-
 auto FlowControl::command_data_received(zmq::Message&& in) noexcept -> void
 {
     if (0 == in.arg_count()) { abort(); }
@@ -226,7 +326,10 @@ auto FlowControl::command_data_received(zmq::Message&& in) noexcept -> void
     auto process{false};
     auto realtime{false};
 
-    switch (parse_(in.arg(0).str())) {
+    const auto line = in.arg(0).str();
+    discover_buffer(line);
+
+    switch (parse_(line)) {
         case Classifier::Type::Empty: {
             // std::cout << "Classify: empty\n";  // FIXME
             parse_.reset();
@@ -243,6 +346,8 @@ auto FlowControl::command_data_received(zmq::Message&& in) noexcept -> void
             message.emplace_back(sub);
             parse_.dump(message);
             parent_socket_.send(std::move(message));
+            compact_reset();
+            planner_.expire();
             alarm_ = false;
             process = false;
         } break;
@@ -256,6 +361,7 @@ auto FlowControl::command_data_received(zmq::Message&& in) noexcept -> void
         } break;
         case Classifier::Type::Status: {
             // std::cout << "Classify: status\n";  // FIXME
+            publish_status(line);
             process = true;
             realtime = true;
         } break;
@@ -265,9 +371,13 @@ auto FlowControl::command_data_received(zmq::Message&& in) noexcept -> void
         } break;
         case Classifier::Type::Alarm: {
             // std::cout << "Classify: alarm\n";  // FIXME
-            // FIXME relay to parent socket
-            parse_.reset();  // FIXME
+            auto message = zeromq_.Command(Command::GrblPushReceived);
+            message.emplace_back(usb_id_.data(), usb_id_.size());
+            parse_.dump(message);
+            parent_socket_.send(std::move(message));
             alarm_ = true;
+            program_abort();
+            compact_reset();
             process = false;
         } break;
         case Classifier::Type::Response: {
@@ -288,9 +398,114 @@ auto FlowControl::command_data_received(zmq::Message&& in) noexcept -> void
     if (process) { receive(realtime); }
 }
 
+// Returns line unchanged when compaction is disabled. Otherwise the result is
+// only valid until the next call.
+auto FlowControl::compact(const std::string_view line) noexcept
+    -> std::string_view
+{
+    if (false == compact_.has_value()) { return line; }
+
+    (*compact_)(line, compacted_);
+
+    return compacted_;
+}
+
+auto FlowControl::compact_reset() noexcept -> void
+{
+    if (compact_.has_value()) { compact_->reset(); }
+}
+
+// With character counting the number of lines in flight is the receive buffer
+// size divided by the average line length, so the ratio of the two averages is
+// the change in line throughput when the device is not the bottleneck
+auto FlowControl::compaction_report() const noexcept -> void
+{
+    if (false == compact_.has_value()) { return; }
+
+    const auto& [lines, in, out] = compact_->statistics();
+
+    if ((0 == lines) || (0 == out)) { return; }
+
+    const auto window = static_cast<double>(limit_ + 1u);
+    const auto count = static_cast<double>(lines);
+    const auto before = static_cast<double>(in);
+    const auto after = static_cast<double>(out);
+    log::info(
+        "Compaction for ",
+        usb_id_,
+        ": ",
+        in,
+        " -> ",
+        out,
+        " bytes (",
+        100.0 * (before - after) / before,
+        "% saved), ",
+        window * count / before,
+        " -> ",
+        window * count / after,
+        " lines in flight");
+}
+
 auto FlowControl::command_enable_flow_control(zmq::Message&&) noexcept -> void
 {
     active_ = true;
+    schedule_status();
+}
+
+auto FlowControl::command_execute_program(zmq::Message&& in) noexcept -> void
+{
+    if (3 > in.arg_count()) { abort(); }
+
+    if (stream_.program_) {
+        log::warning("Program already running on ", usb_id_);
+
+        return;
+    }
+
+    const auto path = in.arg(1).str();
+    stream_ = ProgramStream{};
+    stream_.program_ = (0 == path.size())
+                           ? gcode::Program::Buffer(zmq::Frame{in.arg(2)})
+                           : gcode::Program::Map(std::string{path});
+
+    if ((false == active_) || (false == bool(stream_.program_))) {
+        program_finish(LS_PROGRAM_FAILED);
+
+        return;
+    }
+
+    if (0.0 < path_tolerance_) { stream_.optimizer_.emplace(path_tolerance_); }
+
+    auto& program = *stream_.program_;
+    const auto resumed = (Command::ResumeProgram == in.type());
+    program_index(in, resumed);
+
+    if (resumed) {
+        // NOTE a resumed run is partial so the cache is not used for it
+        if (4 > in.arg_count()) { abort(); }
+
+        const auto line = in.arg(3).as<std::uint64_t>();
+        auto offset = std::size_t{0};
+        const auto found = resume_->seek(
+            program.text(), line, offset, stream_.preamble_);
+
+        if (false == found) {
+            log::warning("Line ", line, " not found in program on ", usb_id_);
+            program_finish(LS_PROGRAM_FAILED);
+
+            return;
+        }
+
+        program.seek(offset, line - 1u);
+        stream_.progress_.lines_read_ = line - 1u;
+        compact_reset();
+    } else {
+        program_cache();
+    }
+    stream_.progress_.state_ = LS_PROGRAM_RUNNING;
+    program_report(true);
+    run();
+    schedule_status();
 }
 
 auto FlowControl::command_send_message(zmq::Message&& in) noexcept -> void
@@ -363,19 +578,19 @@ auto FlowControl::command_send_message(zmq::Message&& in) noexcept -> void
           Flag::SingleLine,
           Flag::Unplanned}},
         {Command::GrblCycleToggle,  // ~
-         {Queue::Front,
+         {Queue::Immediate,
           Flag::Realtime,
           Flag::CanBuffer,
           Flag::SingleLine,
           Flag::Unplanned}},
         {Command::GrblFeedHold,  // !
-         {Queue::Front,
+         {Queue::Immediate,
           Flag::Realtime,
           Flag::CanBuffer,
           Flag::SingleLine,
           Flag::Unplanned}},
         {Command::GrblJogCancel,  // 0x85
-         {Queue::Front,
+         {Queue::Immediate,
           Flag::Realtime,
           Flag::CanBuffer,
           Flag::SingleLine,
@@ -394,11 +609,36 @@ auto FlowControl::command_send_message(zmq::Message&& in) noexcept -> void
     const auto clearsAlarm =
         (Command::GrblSoftReset == type) || (Command::GrblResetAlarm == type);
 
-    if (active_) {
-        queue({type, buffer(in.arg(1).str())}, flags.at(type), clearsAlarm);
-    } else {
+    if (false == active_) {
         serial_socket_.send(std::move(in));
+
+        return;
+    }
+
+    const auto text = in.arg(1).str();
+
+    // NOTE toggling check mode performs a soft reset
+    if (Command::GrblCheckModeToggle == type) { compact_reset(); }
+
+    if ((Command::SendGcode == type) && compact_.has_value()) {
+        auto line = text;
+
+        while ((0 < line.size()) &&
+               (('\n' == line.back()) || ('\r' == line.back()))) {
+            line.remove_suffix(1);
+        }
+
+        // NOTE compaction is enabled so the result is always compacted_
+        if (0 < compact(line).size()) {
+            if (line.size() < text.size()) { compacted_.push_back('\n'); }
+
+            queue({type, compacted_}, flags.at(type), clearsAlarm);
+
+            return;
+        }
     }
+
+    queue({type, text}, flags.at(type), clearsAlarm);
 }
 
 auto FlowControl::command_usb_device_added(zmq::Message&& in) noexcept -> void
@@ -410,11 +650,34 @@ auto FlowControl::command_usb_device_added(zmq::Message&& in) noexcept -> void
 
 auto FlowControl::command_usb_device_removed(zmq::Message&& in) noexcept -> void
 {
+    compaction_report();
+
     if (active_) { queue({}, {Queue::Reconnect}, true); }
 
     serial_socket_.send(std::move(in));
 }
 
+// Grbl 1.1 reports its receive buffer size in the [OPT:] line of $I and the
+// currently available space in the Bf: field of status reports. The latter
+// equals the buffer size whenever no queued bytes are outstanding.
+auto FlowControl::discover_buffer(const std::string_view line) noexcept -> void
+{
+    if (false == starts_with(line, OptionPrefix)) { return; }
+
+    const auto comma = line.find(',');
+
+    if (std::string_view::npos == comma) { return; }
+
+    auto blocks = std::size_t{};
+    auto bytes = std::size_t{};
+
+    if (parse_pair(line.substr(comma + 1u), blocks, bytes)) {
+        planner_.resize(blocks);
+        planner_.expire();
+        resize_window(bytes);
+    }
+}
+
 auto FlowControl::process_command(zmq::Message&& command) noexcept -> bool
 {
     auto disconnectAfter{false};
@@ -447,9 +710,18 @@ auto FlowControl::process_command(zmq::Message&& command) noexcept -> bool
         case Command::GrblCycleToggle:
         case Command::GrblFeedHold:
         case Command::GrblJogCancel:
-        case Command::SendGcode: {
+        case Command::SendGcode:
+        case Command::ExecuteProgram:
+        case Command::ResumeProgram: {
             if (alarm_) {
-                std::cout << "Reset alarm first\n";
+                log::warning("Reset alarm first");
+
+                return disconnectAfter;
+            }
+
+            if ((Command::ExecuteProgram == command.type()) ||
+                (Command::ResumeProgram == command.type())) {
+                command_execute_program(std::move(command));
 
                 return disconnectAfter;
             }
@@ -462,8 +734,13 @@ auto FlowControl::process_command(zmq::Message&& command) noexcept -> bool
         case Command::Invalid:
         case Command::ListDevices:
         case Command::Subscribe:
+        case Command::SubscribeEvents:
         case Command::Unsubscribe:
-        case Command::ExecuteProgram:
+        case Command::AnalyzeProgram:
+        case Command::EventsDropped:
+        case Command::ProgramAnalysis:
+        case Command::StatusReport:
+        case Command::ProgramProgress:
         case Command::PushDeviceRemoved:
         case Command::PushDeviceAdded:
         case Command::ListDevicesReply:
@@ -479,138 +756,582 @@ auto FlowControl::process_command(zmq::Message&& command) noexcept -> bool
     return disconnectAfter;
 }
 
+// Sends the status poll and schedules the next one
+auto FlowControl::process_timer() noexcept -> void
+{
+    static constexpr auto flags = SendFlags{
+        Queue::Front,
+        Flag::Realtime,
+        Flag::CanBuffer,
+        Flag::SingleLine,
+        Flag::Unplanned};
+
+    if (false == active_) { return; }
+
+    const auto expired = Clock::now() >= (status_sent_ + StatusTimeout);
+
+    if ((false == realtime_.empty()) && expired) {
+        // NOTE the device is not going to answer
+        realtime_.clear();
+    }
+
+    if (false == alarm_) { queue({Command::GrblStatus, "?"}, flags, false); }
+
+    schedule_status();
+}
+
+// Removes unsent program lines from the incoming queue. Lines which were
+// already sent are still acknowledged by the device but no longer counted.
+auto FlowControl::program_abort() noexcept -> void
+{
+    if (false == bool(stream_.program_)) { return; }
+
+    incoming_.erase_if([](const auto& item) {
+        return Command::ExecuteProgram == item.first;
+    });
+    program_finish(LS_PROGRAM_ABORTED);
+}
+
+// Programs are identified by their text and every setting which changes the
+// lines transmitted for them. A program found in the cache is streamed from it
+// directly, otherwise the transmitted lines are recorded so a complete run
+// can be added to the cache.
+auto FlowControl::program_cache() noexcept -> void
+{
+    if (false == cache_.has_value()) { return; }
+
+    auto& program = *stream_.program_;
+    auto settings = std::string{"v1;"};
+    settings.append(std::to_string(limit_));
+
+    if (compact_.has_value()) {
+        settings.append(";compact;");
+        settings.append(std::to_string(compact_->precision()));
+    }
+
+    if (stream_.optimizer_.has_value()) {
+        settings.append(";optimize;");
+        settings.append(std::to_string(path_tolerance_));
+    }
+
+    const auto key = gcode::Cache::Hash(program.text(), settings);
+    // NOTE compaction of a recorded program starts from the reset state so it
+    // does not depend on whatever was sent before it
+    compact_reset();
+    auto cached = cache_->find(key);
+
+    if (cached && (program.size() == cached->source_size())) {
+        stream_.progress_.errors_ = cached->errors();
+        stream_.rejected_ = cached->errors();
+        stream_.optimizer_.reset();
+        stream_.cached_ = std::move(cached);
+        // NOTE lines streamed from the cache are not read from the program,
+        // so its resume index is restored from the entry instead
+        resume_->load(stream_.cached_->checkpoints());
+        log::info("Streaming cached program on ", usb_id_);
+    } else {
+        stream_.recorder_ = cache_->record(key);
+    }
+}
+
+auto FlowControl::program_fill() noexcept -> void
+{
+    if (false == bool(stream_.program_)) { return; }
+
+    auto& program = *stream_.program_;
+    auto& progress = stream_.progress_;
+    auto read = false;
+
+    if (stream_.cached_) {
+        const auto& cached = *stream_.cached_;
+
+        while ((ProgramReadAhead > stream_.queued_) &&
+               (stream_.cached_next_ < cached.count())) {
+            const auto index = stream_.cached_next_++;
+            const auto line = cached.line(index);
+
+            if (0 == line.size()) {
+                program_finish(LS_PROGRAM_FAILED);
+
+                return;
+            }
+
+            const auto entry = cached.entry(index);
+            progress.lines_read_ = entry.source_line_;
+            progress.bytes_read_ = entry.source_offset_;
+            program_queue(line, false);
+        }
+
+        read = stream_.cached_next_ >= cached.count();
+
+        if (read) {
+            progress.lines_read_ = cached.source_lines();
+            progress.bytes_read_ = cached.source_size();
+        }
+    } else {
+        auto line = std::string_view{};
+
+        while ((ProgramReadAhead > stream_.queued_) && program_line(line)) {
+            while ((0 < line.size()) && is_space(line.front())) {
+                line.remove_prefix(1);
+            }
+
+            while ((0 < line.size()) && is_space(line.back())) {
+                line.remove_suffix(1);
+            }
+
+            if (0 == line.size()) { continue; }
+
+            const auto text = compact(line);
+
+            if (0 == text.size()) { continue; }
+
+            if (text.size() >= limit_) {
+                ++progress.errors_;
+                ++stream_.rejected_;
+                // NOTE the compactor assumed the device would see this line
+                compact_reset();
+
+                continue;
+            }
+
+            program_queue(text, true);
+        }
+
+        progress.bytes_read_ = program.offset();
+        const auto& optimizer = stream_.optimizer_;
+        read = (program.offset() >= program.size()) &&
+               ((false == optimizer.has_value()) || optimizer->empty());
+    }
+
+    const auto done =
+        read && (0 == stream_.queued_) && (0 == stream_.pending_);
+
+    if (done) { program_finish(LS_PROGRAM_COMPLETE); }
+}
+
+auto FlowControl::program_finish(const LS_ProgramState state) noexcept -> void
+{
+    auto& progress = stream_.progress_;
+    progress.state_ = state;
+    program_report(true);
+
+    // NOTE error responses reset the compactor, which changes the lines sent
+    // after them, so only runs without device errors are cached
+    const auto cache = (LS_PROGRAM_COMPLETE == state) && stream_.recorder_ &&
+                       (progress.errors_ == stream_.rejected_);
+
+    if (cache) {
+        auto checkpoints = std::string{};
+
+        if (resume_.has_value()) { resume_->save(checkpoints); }
+
+        cache_->commit(
+            std::move(stream_.recorder_),
+            stream_.rejected_,
+            progress.lines_read_,
+            stream_.program_->size(),
+            checkpoints);
+    }
+
+    // The compactor did not see the lines of a cached program
+    if (stream_.cached_) { compact_reset(); }
+
+    if (stream_.optimizer_.has_value()) {
+        const auto& [in, out, arcs, lines] = stream_.optimizer_->statistics();
+        log::info(
+            "Path optimization for ",
+            usb_id_,
+            ": ",
+            in,
+            " -> ",
+            out,
+            " lines (",
+            arcs,
+            " arcs, ",
+            lines,
+            " merged lines)");
+    }
+
+    stream_ = ProgramStream{};
+    compaction_report();
+}
+
+// A mapped program is recognized by the identity of its file, so finding its
+// resume index does not read the program. A buffered program is compared with
+// the previous one only when a run is resumed, and otherwise indexed afresh.
+auto FlowControl::program_index(const zmq::Message& in, const bool resumed)
+    noexcept -> void
+{
+    const auto& program = *stream_.program_;
+    const auto buffered = (0 == program.identity().size());
+    const auto key = gcode::Cache::Hash(program.identity(), {});
+    auto found = resumed && resume_.has_value() && (key == resume_->key());
+
+    if (found && buffered) {
+        found = resume_text_.has_value() &&
+                (resume_text_->str() == program.text());
+    }
+
+    if (found) { return; }
+
+    resume_.emplace(key);
+    resume_text_.reset();
+
+    if (buffered) { resume_text_.emplace(in.arg(2)); }
+}
+
+// Reads the next line of the program, passing it through the path optimizer
+// when enabled. The optimizer holds back moves while they still fit the
+// current line or arc so several program lines may be read per output line.
+auto FlowControl::program_line(std::string_view& line) noexcept -> bool
+{
+    if (false == stream_.optimizer_.has_value()) { return program_next(line); }
+
+    auto& optimizer = *stream_.optimizer_;
+
+    while (false == optimizer.next(stream_.optimized_)) {
+        if (program_next(line)) {
+            optimizer.push(line);
+        } else if (optimizer.empty()) {
+            return false;
+        } else {
+            optimizer.flush();
+        }
+    }
+
+    line = stream_.optimized_;
+
+    return true;
+}
+
+// Returns the preamble of a resumed program followed by the program lines,
+// which are added to the resume index as they are read
+auto FlowControl::program_next(std::string_view& line) noexcept -> bool
+{
+    auto& preamble = stream_.preamble_;
+
+    if (stream_.preamble_next_ < preamble.size()) {
+        line = preamble.at(stream_.preamble_next_++);
+
+        return true;
+    }
+
+    auto& program = *stream_.program_;
+
+    if (false == program.next(line)) { return false; }
+
+    ++stream_.progress_.lines_read_;
+
+    if (resume_.has_value()) {
+        resume_->read(line, program.line(), program.offset());
+    }
+
+    return true;
+}
+
+// Queues one transmitted program line and records it when the program is being
+// added to the cache. Cached lines already include their terminator.
+auto FlowControl::program_queue(
+    const std::string_view text,
+    const bool terminate) noexcept -> void
+{
+    static constexpr auto flags = SendFlags{
+        Queue::Back,
+        Flag::Queued,
+        Flag::CanBuffer,
+        Flag::SingleLine,
+        Flag::Planned};
+
+    if (false == incoming_.push_back(
+                     {Command::ExecuteProgram, flags}, text, terminate)) {
+        // NOTE only possible for a cached line wider than the current slots
+        ++stream_.progress_.errors_;
+        ++stream_.rejected_;
+
+        return;
+    }
+
+    if (stream_.recorder_) {
+        stream_.recorder_->add(
+            incoming_.back().second,
+            stream_.program_->offset(),
+            stream_.progress_.lines_read_);
+    }
+
+    ++stream_.queued_;
+}
+
+auto FlowControl::program_report(const bool force) noexcept -> void
+{
+    const auto now = std::chrono::steady_clock::now();
+
+    if ((false == force) && (now < stream_.reported_ + ProgramReportInterval)) {
+        return;
+    }
+
+    stream_.reported_ = now;
+    auto message = zeromq_.Command(Command::ProgramProgress);
+    message.emplace_back(usb_id_.data(), usb_id_.size());
+    message.emplace_back(stream_.progress_);
+    parent_socket_.send(std::move(message));
+}
+
+auto FlowControl::program_response(const Request& request) noexcept -> void
+{
+    if (false == bool(stream_.program_)) {
+        parse_.reset();
+
+        return;
+    }
+
+    --stream_.pending_;
+    auto& progress = stream_.progress_;
+    ++progress.lines_acknowledged_;
+
+    if (parse_.failed()) {
+        ++progress.errors_;
+        response_received(request);
+    } else {
+        parse_.reset();
+    }
+
+    program_report(false);
+}
+
+auto FlowControl::publish_status(const std::string_view line) noexcept -> void
+{
+    if (false == grbl::parse_status(line, status_)) { return; }
+
+    if (0 != (status_.fields_ & LS_STATUS_BUFFER)) {
+        planner_.report(status_.planner_available_);
+
+        if (0 == used_) { resize_window(status_.rx_available_); }
+    }
+
+    auto message = zeromq_.Command(Command::StatusReport);
+    message.emplace_back(usb_id_.data(), usb_id_.size());
+    message.emplace_back(status_);
+    parent_socket_.send(std::move(message));
+    schedule_status();
+}
+
 auto FlowControl::queue(
-    const Request request,
+    const Request& request,
     const SendFlags flags,
     const bool clearsAlarm) noexcept -> void
 {
     const auto& [type, bytes] = request;
+    auto queued{true};
 
     assert(bytes.size() <= limit_);
 
     validate(flags);
 
+    if ((Command::GrblStatus == type) && (false == realtime_.empty())) {
+        // NOTE the outstanding request is answered to every subscriber
+        return;
+    }
+
     switch (flags.position_) {
         case Queue::Reconnect: {
+            program_abort();
             outgoing_.clear();
             used_ = 0;
             [[fallthrough]];
         }
         case Queue::Reset: {
             incoming_.clear();
+            compact_reset();
             [[fallthrough]];
         }
         case Queue::Front: {
-            if (0 < bytes.size()) { incoming_.emplace_front(request, flags); }
+            if (0 < bytes.size()) {
+                queued = incoming_.push_front({type, flags}, bytes);
+            }
         } break;
         case Queue::Back: {
-            if (0 < bytes.size()) { incoming_.emplace_back(request, flags); }
+            if (0 < bytes.size()) {
+                queued = incoming_.push_back({type, flags}, bytes);
+            }
         } break;
+        case Queue::Immediate: {
+            transmit(bytes);
+
+            return;
+        }
         default: {
         }
     }
 
+    if (false == queued) {
+        log::warning(
+            "Discarding ",
+            bytes.size(),
+            " byte command for ",
+            usb_id_,
+            " which does not fit the receive buffer");
+    }
+
     run(clearsAlarm);
+    schedule_status();
 }
 
+// The answered request stays queued while it is processed so its bytes remain
+// valid without being copied
 auto FlowControl::receive(const bool realtime) noexcept -> void
 {
-    response_received(realtime ? receive_realtime() : receive_normal());
-    run();
-}
+    auto& queue = realtime ? realtime_ : outgoing_;
+    auto request = Request{};
 
-auto FlowControl::receive_normal() noexcept -> Request
-{
-    auto output = Request{};
+    if (false == queue.empty()) {
+        const auto [header, bytes] = queue.front();
+        request = {header.first, bytes};
+    }
 
-    if (false == outgoing_.empty()) {
-        const auto& [flags, size, request] = outgoing_.front();
-        output = request;
-        const auto& [position, realtime, greedy, multiline, planned] = flags;
+    // NOTE a rejected block did not change the modal state the compactor
+    // assumed it would
+    if (parse_.failed()) { compact_reset(); }
+
+    if (Command::Invalid == request.first) {
+        // NOTE nothing was outstanding, for example an automatic status report
+        auto message = zeromq_.Command(Command::GrblPushReceived);
+        message.emplace_back(usb_id_.data(), usb_id_.size());
+        parse_.dump(message);
+        parent_socket_.send(std::move(message));
+    } else if (Command::ExecuteProgram == request.first) {
+        program_response(request);
+    } else {
+        response_received(request);
+    }
 
-        if (value(planned)) { used_ -= size; }
+    if (false == queue.empty()) {
+        const auto& flags = queue.front().first.second;
 
-        outgoing_.pop_front();
+        if (value(flags.planned_)) {
+            used_ -= request.second.size();
+            planner_.expire();
+        }
+
+        queue.pop_front();
     }
 
-    return output;
+    run();
 }
 
-auto FlowControl::receive_realtime() noexcept -> Request
+auto FlowControl::resize_window(const std::size_t bytes) noexcept -> void
 {
-    auto output = Request{};
-
-    if (realtime_.has_value()) {
-        const auto& [flags, size, request] = realtime_.value();
-        output = request;
-        realtime_ = std::nullopt;
+    if ((1u < bytes) && (bytes - 1u != limit_)) {
+        limit_ = bytes - 1u;
+        incoming_.reserve(limit_);
+        outgoing_.reserve(limit_);
+        realtime_.reserve(limit_);
+        log::info(
+            "Receive buffer for ",
+            usb_id_,
+            ": ",
+            bytes,
+            " bytes, ",
+            planner_.size(),
+            " planner blocks");
     }
-
-    return output;
 }
 
-auto FlowControl::response_received(const Request request) noexcept -> void
+auto FlowControl::response_received(const Request& request) noexcept -> void
 {
-    const auto [type, bytes] = request;
+    const auto& [type, bytes] = request;
     auto message = zeromq_.Command(Command::ResponseReceived);
     message.emplace_back(usb_id_.data(), usb_id_.size());
     message.emplace_back(type);
-    message.emplace_back(
-        reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    message.emplace_back(bytes.data(), bytes.size());
     parse_.dump(message);
     parent_socket_.send(std::move(message));
 }
 
 auto FlowControl::run(const bool clearsAlarm) noexcept -> void
 {
-    auto available = limit_ - used_;
+    auto available = (limit_ > used_) ? (limit_ - used_) : std::size_t{0};
+    // NOTE a line sent while the planner is full waits in the receive buffer
+    // where it delays commands queued behind it, and one waiting line is
+    // enough to refill the planner as soon as a block completes
+    const auto plannerFull = planner_.full();
 
     if (alarm_ && (false == clearsAlarm)) { return; }
 
+    program_fill();
+
     while (false == incoming_.empty()) {
-        const auto& [request, flags] = incoming_.front();
-        const auto& [type, bytes] = request;
+        const auto [header, bytes] = incoming_.front();
+        const auto& [type, flags] = header;
         const auto& [position, realtime, greedy, multiline, planned] = flags;
         const auto size = bytes.size();
 
         if (value(planned)) {
             if (size > available) { return; }
 
+            if (plannerFull && (0 < used_)) { return; }
+
             used_ += size;
             available -= size;
         } else {
             if (value(greedy) && (0 < outgoing_.size())) { return; }
 
-            if (value(realtime) && realtime_.has_value()) { return; }
+            if (value(realtime) && (false == realtime_.empty())) { return; }
         }
 
         transmit(bytes);
 
+        if (Command::ExecuteProgram == type) {
+            --stream_.queued_;
+            ++stream_.pending_;
+            ++stream_.progress_.lines_sent_;
+            stream_.progress_.bytes_sent_ += size;
+        }
+
         if (Queue::Reset == position) {
+            program_abort();
             active_ = false;
             outgoing_.clear();
             incoming_.clear();
-            realtime_ = std::nullopt;
+            realtime_.clear();
             used_ = 0;
+            planner_.expire();
         } else {
             if (value(realtime)) {
-                assert(false == realtime_.has_value());
+                assert(realtime_.empty());
 
-                realtime_.emplace(flags, size, request);
+                realtime_.push_back(header, bytes);
+                status_sent_ = Clock::now();
             } else {
-                outgoing_.emplace_back(flags, size, request);
+                outgoing_.push_back(header, bytes);
             }
 
             incoming_.pop_front();
-            const auto& next = outgoing_.front();
-            const auto& nextFlags = std::get<0>(next);
 
-            if (value(nextFlags.multiline_)) { parse_.start_multiline(); }
+            if (false == outgoing_.empty()) {
+                const auto& nextFlags = outgoing_.front().first.second;
+
+                if (value(nextFlags.multiline_)) { parse_.start_multiline(); }
+            }
         }
+
+        if (incoming_.empty()) { program_fill(); }
     }
 }
 
-auto FlowControl::transmit(const Bytes& bytes) noexcept -> void
+// Polls faster while the machine is moving or has work queued. Only ever moves
+// the next poll earlier so frequent calls do not postpone it.
+auto FlowControl::schedule_status() noexcept -> void
+{
+    if ((false == active_) || (0 == status_active_.count())) { return; }
+
+    const auto busy = (0 < used_) || (false == incoming_.empty()) ||
+                      bool(stream_.program_) || is_moving(status_.state_);
+    const auto interval = busy ? status_active_ : status_idle_;
+    set_timer(std::min(timer(), Clock::now() + interval));
+}
+
+auto FlowControl::transmit(const std::string_view bytes) noexcept -> void
 {
     auto message = zeromq_.Command(Command::SendGcode);
     message.emplace_back();
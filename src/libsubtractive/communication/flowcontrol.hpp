@@ -3,18 +3,26 @@
 // IWYU pragma: no_include <ext/type_traits>
 
 #include <atomic>
-#include <deque>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <iosfwd>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
-#include <tuple>
 #include <type_traits>  // IWYU pragma: keep
 #include <utility>
 #include <vector>
 
 #include "libsubtractive/actor.hpp"
+#include "libsubtractive/communication/linering.hpp"
+#include "libsubtractive/communication/pipe.hpp"
+#include "libsubtractive/communication/planner.hpp"
+#include "libsubtractive/gcode/cache.hpp"
+#include "libsubtractive/gcode/compactor.hpp"
+#include "libsubtractive/gcode/optimizer.hpp"
+#include "libsubtractive/gcode/resume.hpp"
 #include "libsubtractive/protocol/Grbl.hpp"
 
 namespace libsubtractive
@@ -25,6 +33,11 @@ class Context;
 class Message;
 class Socket;
 }  // namespace zmq
+
+namespace gcode
+{
+class Program;
+}  // namespace gcode
 }  // namespace libsubtractive
 
 namespace libsubtractive
@@ -37,13 +50,17 @@ public:
         Reset = -1,
         Back = 0,
         Front = 1,
+        // Sent without being queued or tracked since no response is expected
+        Immediate = 2,
     };
 
     FlowControl(
         const zmq::Context& zeromq,
+        Reactor* reactor,
+        const LS_options& options,
         const std::string_view serialNumber,
-        const std::string serialEndpoint,
-        const std::string flowEndpoint);
+        Endpoint serialEndpoint,
+        Endpoint flowEndpoint);
 
     ~FlowControl();
 
@@ -69,12 +86,29 @@ private:
         Flag planned_{Flag::Planned};
     };
 
-    using Bytes = std::vector<std::byte>;
-    using Request = std::pair<Command, Bytes>;
-    using Queued = std::tuple<Request, SendFlags>;
-    using IncomingBuffer = std::deque<Queued>;
-    using Pending = std::tuple<SendFlags, std::size_t, Request>;
-    using OutgoingBuffer = std::deque<Pending>;
+    // NOTE the bytes of a request are a view of a queued line or of the
+    // message it arrived in
+    using Request = std::pair<Command, std::string_view>;
+    using Queued = std::pair<Command, SendFlags>;
+    using LineBuffer = LineRing<Queued>;
+
+    struct ProgramStream {
+        std::unique_ptr<gcode::Program> program_{};
+        std::optional<gcode::Optimizer> optimizer_{};
+        std::string optimized_{};
+        // Lines which restore the modal state of a resumed program
+        std::vector<std::string> preamble_{};
+        std::size_t preamble_next_{};
+        std::unique_ptr<gcode::Cache::Reader> cached_{};
+        std::size_t cached_next_{};
+        std::unique_ptr<gcode::Cache::Writer> recorder_{};
+        // Lines not transmitted because they exceed the receive buffer
+        std::uint64_t rejected_{};
+        LS_program_progress progress_{};
+        std::size_t queued_{};
+        std::size_t pending_{};
+        std::chrono::steady_clock::time_point reported_{};
+    };
 
     struct Classifier {
         enum class Type : std::uint8_t {
@@ -89,6 +123,7 @@ private:
             Alarm,
         };
 
+        auto failed() const noexcept -> bool;
         auto version() const noexcept -> grbl::VersionData;
 
         auto operator()(const std::string_view line) noexcept -> Type;
@@ -110,18 +145,34 @@ private:
     };
 
     const std::string usb_id_;
-    const std::size_t limit_;
-    const zmq::Socket& parent_socket_;
-    const zmq::Socket& serial_socket_;
+    // NOTE limit_ is one less than the size of the device receive buffer
+    std::size_t limit_;
+    Planner planner_;
+    const Channel parent_socket_;
+    const Channel serial_socket_;
     Classifier parse_;
     std::atomic_bool active_;
     std::atomic_bool alarm_;
-    IncomingBuffer incoming_;
-    OutgoingBuffer outgoing_;
-    std::optional<Pending> realtime_;
+    LineBuffer incoming_;
+    LineBuffer outgoing_;
+    // Holds at most the one outstanding realtime request
+    LineBuffer realtime_;
     std::size_t used_;
+    ProgramStream stream_;
+    LS_status_report status_;
+    const std::chrono::milliseconds status_active_;
+    const std::chrono::milliseconds status_idle_;
+    Clock::time_point status_sent_;
+    std::optional<gcode::Compactor> compact_;
+    std::string compacted_;
+    const double path_tolerance_;
+    std::optional<gcode::Cache> cache_;
+    // Index of the most recent program, kept after it stops so it can be
+    // resumed
+    std::optional<gcode::Resume> resume_;
+    // Text of the most recent program when it was buffered rather than mapped
+    std::optional<zmq::Frame> resume_text_;
 
-    static auto buffer(const std::string_view bytes) -> std::vector<std::byte>;
     static constexpr auto validate(const SendFlags& flags)
     {
         const auto& [position, realtime, greedy, multiline, planned] = flags;
@@ -132,6 +183,10 @@ private:
             assert(Flag::SingleLine == multiline);
         }
 
+        if (Queue::Immediate == position) {
+            assert(Flag::Realtime == realtime);
+        }
+
         if (Flag::Realtime == realtime) {
             assert(Flag::Unplanned == planned);
             assert(Flag::SingleLine == multiline);
@@ -148,20 +203,40 @@ private:
     }
 
     auto command_data_received(zmq::Message&& in) noexcept -> void;
+    auto compact(const std::string_view line) noexcept -> std::string_view;
+    auto compact_reset() noexcept -> void;
+    auto compaction_report() const noexcept -> void;
     auto command_enable_flow_control(zmq::Message&& in) noexcept -> void;
+    auto command_execute_program(zmq::Message&& in) noexcept -> void;
     auto command_send_message(zmq::Message&& in) noexcept -> void;
     auto command_usb_device_added(zmq::Message&& in) noexcept -> void;
     auto command_usb_device_removed(zmq::Message&& in) noexcept -> void;
+    auto discover_buffer(const std::string_view line) noexcept -> void;
     auto process_command(zmq::Message&& command) noexcept -> bool;
+    auto process_timer() noexcept -> void;
+    auto program_abort() noexcept -> void;
+    auto program_cache() noexcept -> void;
+    auto program_fill() noexcept -> void;
+    auto program_finish(const LS_ProgramState state) noexcept -> void;
+    auto program_index(const zmq::Message& in, const bool resumed) noexcept
+        -> void;
+    auto program_line(std::string_view& line) noexcept -> bool;
+    auto program_next(std::string_view& line) noexcept -> bool;
+    auto program_queue(
+        const std::string_view text,
+        const bool terminate) noexcept -> void;
+    auto program_report(const bool force) noexcept -> void;
+    auto program_response(const Request& request) noexcept -> void;
+    auto publish_status(const std::string_view line) noexcept -> void;
     auto queue(
-        const Request request,
+        const Request& request,
         const SendFlags flags,
         const bool clearsAlarm) noexcept -> void;
     auto receive(const bool realtime) noexcept -> void;
-    auto receive_normal() noexcept -> Request;
-    auto receive_realtime() noexcept -> Request;
-    auto response_received(const Request request) noexcept -> void;
+    auto resize_window(const std::size_t bytes) noexcept -> void;
+    auto response_received(const Request& request) noexcept -> void;
     auto run(const bool clearsAlarm = false) noexcept -> void;
-    auto transmit(const Bytes& bytes) noexcept -> void;
+    auto schedule_status() noexcept -> void;
+    auto transmit(const std::string_view bytes) noexcept -> void;
 };
 }  // namespace libsubtractive
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace libsubtractive
+{
+// Queue of short lines, each copied into a fixed width slot next to a header.
+// Every slot is allocated up front so queueing and removing lines does not
+// touch the heap unless the ring has to grow.
+//
+// NOTE the views returned by front() and back() are invalidated by any
+// function which adds a line or calls reserve()
+template <typename Header>
+class LineRing
+{
+public:
+    using Line = std::pair<const Header&, std::string_view>;
+
+    auto back() const noexcept -> Line
+    {
+        assert(false == empty());
+
+        return at(count_ - 1u);
+    }
+    auto capacity() const noexcept -> std::size_t { return headers_.size(); }
+    auto empty() const noexcept -> bool { return 0u == count_; }
+    auto front() const noexcept -> Line
+    {
+        assert(false == empty());
+
+        return at(0u);
+    }
+    auto size() const noexcept -> std::size_t { return count_; }
+    auto width() const noexcept -> std::size_t { return width_; }
+
+    auto clear() noexcept -> void
+    {
+        first_ = 0u;
+        count_ = 0u;
+    }
+    // Removes every line whose header satisfies pred, keeping the order of
+    // the others
+    template <typename Predicate>
+    auto erase_if(Predicate pred) noexcept -> void
+    {
+        auto kept = std::size_t{0};
+
+        for (auto i = std::size_t{0}; i < count_; ++i) {
+            const auto from = slot(i);
+
+            if (pred(headers_[from])) { continue; }
+
+            if (kept != i) { copy(from, slot(kept)); }
+
+            ++kept;
+        }
+
+        count_ = kept;
+    }
+    auto pop_front() noexcept -> void
+    {
+        assert(false == empty());
+
+        first_ = slot(1u);
+        --count_;
+    }
+    // Returns false without queueing anything if the line, plus a newline
+    // when terminate is set, is wider than a slot
+    auto push_back(
+        const Header& header,
+        const std::string_view bytes,
+        const bool terminate = false) -> bool
+    {
+        if (false == fits(bytes, terminate)) { return false; }
+
+        if (capacity() == count_) { relayout(capacity() * 2u, width_); }
+
+        store(slot(count_), header, bytes, terminate);
+        ++count_;
+
+        return true;
+    }
+    auto push_front(
+        const Header& header,
+        const std::string_view bytes,
+        const bool terminate = false) -> bool
+    {
+        if (false == fits(bytes, terminate)) { return false; }
+
+        if (capacity() == count_) { relayout(capacity() * 2u, width_); }
+
+        first_ = slot(capacity() - 1u);
+        store(first_, header, bytes, terminate);
+        ++count_;
+
+        return true;
+    }
+    // Widens every slot to at least width bytes, keeping the queued lines
+    auto reserve(const std::size_t width) -> void
+    {
+        if (width > width_) { relayout(capacity(), width); }
+    }
+
+    // Capacity is rounded up to a power of two
+    LineRing(const std::size_t capacity, const std::size_t width)
+        : headers_(round(capacity))
+        , sizes_(headers_.size())
+        , bytes_(headers_.size() * width)
+        , width_(width)
+        , first_(0u)
+        , count_(0u)
+    {
+    }
+
+private:
+    std::vector<Header> headers_;
+    std::vector<std::size_t> sizes_;
+    std::vector<char> bytes_;
+    std::size_t width_;
+    std::size_t first_;
+    std::size_t count_;
+
+    static auto round(const std::size_t capacity) noexcept -> std::size_t
+    {
+        auto output = std::size_t{1};
+
+        while (output < capacity) { output <<= 1u; }
+
+        return output;
+    }
+
+    auto at(const std::size_t index) const noexcept -> Line
+    {
+        const auto i = slot(index);
+
+        return {headers_[i], {bytes_.data() + (i * width_), sizes_[i]}};
+    }
+    auto copy(const std::size_t from, const std::size_t to) noexcept -> void
+    {
+        headers_[to] = headers_[from];
+        sizes_[to] = sizes_[from];
+        std::memcpy(
+            bytes_.data() + (to * width_),
+            bytes_.data() + (from * width_),
+            sizes_[from]);
+    }
+    auto fits(const std::string_view bytes, const bool terminate)
+        const noexcept -> bool
+    {
+        return (bytes.size() + (terminate ? 1u : 0u)) <= width_;
+    }
+    auto relayout(const std::size_t capacity, const std::size_t width) -> void
+    {
+        auto next = LineRing{capacity, width};
+
+        for (auto i = std::size_t{0}; i < count_; ++i) {
+            const auto [header, bytes] = at(i);
+            next.store(i, header, bytes, false);
+        }
+
+        headers_.swap(next.headers_);
+        sizes_.swap(next.sizes_);
+        bytes_.swap(next.bytes_);
+        width_ = width;
+        first_ = 0u;
+    }
+    auto slot(const std::size_t index) const noexcept -> std::size_t
+    {
+        return (first_ + index) & (capacity() - 1u);
+    }
+    auto store(
+        const std::size_t i,
+        const Header& header,
+        const std::string_view bytes,
+        const bool terminate) noexcept -> void
+    {
+        auto* const out = bytes_.data() + (i * width_);
+        std::memcpy(out, bytes.data(), bytes.size());
+
+        if (terminate) { out[bytes.size()] = '\n'; }
+
+        headers_[i] = header;
+        sizes_[i] = bytes.size() + (terminate ? 1u : 0u);
+    }
+
+    LineRing() = delete;
+    LineRing(const LineRing&) = delete;
+    LineRing(LineRing&&) = delete;
+    auto operator=(const LineRing&) -> LineRing& = delete;
+    auto operator=(LineRing&&) -> LineRing& = delete;
+};
+}  // namespace libsubtractive
@@ -0,0 +1,193 @@
+#include "libsubtractive/communication/pipe.hpp"  // IWYU pragma: associated
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <array>
+#include <cerrno>
+#include <stdexcept>
+#include <thread>
+
+namespace libsubtractive
+{
+auto round_capacity(const std::size_t capacity) noexcept -> std::size_t;
+auto round_capacity(const std::size_t capacity) noexcept -> std::size_t
+{
+    auto output = std::size_t{1};
+
+    while (output < capacity) { output <<= 1u; }
+
+    return output;
+}
+
+Ring::Ring(const std::size_t capacity)
+    : head_(0)
+    , tail_(0)
+    , mask_(round_capacity(capacity) - 1u)
+    , slots_(mask_ + 1u)
+{
+}
+
+auto Ring::pop(zmq::Message& out) noexcept -> bool
+{
+    const auto tail = tail_.load(std::memory_order_relaxed);
+
+    if (tail == head_.load(std::memory_order_seq_cst)) { return false; }
+
+    out = std::move(slots_[tail & mask_]);
+    tail_.store(tail + 1u, std::memory_order_seq_cst);
+
+    return true;
+}
+
+auto Ring::push(zmq::Message&& in) noexcept -> Push
+{
+    const auto head = head_.load(std::memory_order_relaxed);
+
+    if ((head - tail_.load(std::memory_order_acquire)) > mask_) {
+        return Push::Full;
+    }
+
+    slots_[head & mask_] = std::move(in);
+    head_.store(head + 1u, std::memory_order_seq_cst);
+
+    // NOTE with both sides using sequentially consistent operations on the
+    // indices either the consumer sees the new head before it stops draining
+    // or this load sees that it consumed everything before the new message
+    if (tail_.load(std::memory_order_seq_cst) == head) {
+        return Push::WasEmpty;
+    }
+
+    return Push::Queued;
+}
+
+struct Pipe::Shared {
+    // Ring i carries messages to side i
+    std::array<std::unique_ptr<Ring>, 2> rings_;
+    // Read and write descriptors which signal ring i
+    std::array<std::array<int, 2>, 2> wake_;
+
+    Shared(const std::size_t capacity)
+        : rings_()
+        , wake_()
+    {
+        for (auto i = std::size_t{0}; i < rings_.size(); ++i) {
+            rings_.at(i) = std::make_unique<Ring>(capacity);
+            auto& fds = wake_.at(i);
+
+            if (0 != ::pipe(fds.data())) {
+                throw std::runtime_error("Failed to create pipe");
+            }
+
+            for (const auto fd : fds) {
+                ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+                ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+            }
+        }
+    }
+
+    ~Shared()
+    {
+        for (const auto& fds : wake_) {
+            for (const auto fd : fds) { ::close(fd); }
+        }
+    }
+
+    Shared() = delete;
+    Shared(const Shared&) = delete;
+    Shared(Shared&&) = delete;
+    auto operator=(const Shared&) -> Shared& = delete;
+    auto operator=(Shared&&) -> Shared& = delete;
+};
+
+Pipe::Pipe(std::shared_ptr<Shared> shared, const bool side) noexcept
+    : shared_(std::move(shared))
+    , side_(side)
+{
+}
+
+Pipe::Pipe(Pipe&& rhs) noexcept
+    : shared_(std::move(rhs.shared_))
+    , side_(rhs.side_)
+{
+}
+
+auto Pipe::operator=(Pipe&& rhs) noexcept -> Pipe&
+{
+    shared_ = std::move(rhs.shared_);
+    side_ = rhs.side_;
+
+    return *this;
+}
+
+auto Pipe::Pair(const std::size_t capacity) -> std::pair<Pipe, Pipe>
+{
+    auto shared = std::make_shared<Shared>(capacity);
+
+    return {Pipe{shared, false}, Pipe{shared, true}};
+}
+
+auto Pipe::clear() const noexcept -> void
+{
+    auto buffer = std::array<char, 64>{};
+
+    while (0 < ::read(fd(), buffer.data(), buffer.size())) { ; }
+}
+
+auto Pipe::fd() const noexcept -> int
+{
+    return shared_->wake_.at(side_ ? 1u : 0u).at(0);
+}
+
+auto Pipe::receive(zmq::Message& out) const noexcept -> bool
+{
+    return shared_->rings_.at(side_ ? 1u : 0u)->pop(out);
+}
+
+auto Pipe::send(zmq::Message&& in) const noexcept -> bool
+{
+    const auto peer = side_ ? 0u : 1u;
+    auto& ring = *shared_->rings_.at(peer);
+    auto result = ring.push(std::move(in));
+
+    // NOTE a failed push leaves the message untouched
+    while (Ring::Push::Full == result) {
+        std::this_thread::yield();
+        result = ring.push(std::move(in));
+    }
+
+    if (Ring::Push::WasEmpty == result) {
+        const auto byte = char{0};
+        const auto fd = shared_->wake_.at(peer).at(1);
+
+        while ((0 > ::write(fd, &byte, sizeof(byte))) && (EINTR == errno)) {
+            ;
+        }
+    }
+
+    return true;
+}
+
+auto Pipe::wake() const noexcept -> void
+{
+    const auto byte = char{0};
+    const auto fd = shared_->wake_.at(side_ ? 1u : 0u).at(1);
+
+    while ((0 > ::write(fd, &byte, sizeof(byte))) && (EINTR == errno)) { ; }
+}
+
+Pipe::~Pipe() = default;
+
+auto take_pipes(std::initializer_list<Endpoint*> endpoints) noexcept
+    -> std::vector<Pipe>
+{
+    auto output = std::vector<Pipe>{};
+
+    for (auto* endpoint : endpoints) {
+        if (auto* pipe = std::get_if<Pipe>(endpoint); nullptr != pipe) {
+            output.emplace_back(std::move(*pipe));
+        }
+    }
+
+    return output;
+}
+}  // namespace libsubtractive
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "libsubtractive/communication/zmq/zeromq_wrapper.hpp"
+
+namespace libsubtractive
+{
+// Bounded lock-free queue of messages between exactly one producing thread and
+// one consuming thread. Every slot is allocated up front so a message changes
+// threads by moving its frame vector, without any ZMQ framing.
+class Ring
+{
+public:
+    enum class Push : std::uint8_t {
+        Full,
+        // The consumer may be waiting and must be woken up
+        WasEmpty,
+        Queued,
+    };
+
+    auto pop(zmq::Message& out) noexcept -> bool;
+    auto push(zmq::Message&& in) noexcept -> Push;
+
+    // Capacity is rounded up to a power of two
+    Ring(const std::size_t capacity);
+
+private:
+    // NOTE the indices increase without wrapping and are masked on use.
+    // Each is written by one side only and kept on its own cache line.
+    alignas(64) std::atomic<std::size_t> head_;
+    alignas(64) std::atomic<std::size_t> tail_;
+    alignas(64) const std::size_t mask_;
+    std::vector<zmq::Message> slots_;
+
+    Ring() = delete;
+    Ring(const Ring&) = delete;
+    Ring(Ring&&) = delete;
+    auto operator=(const Ring&) -> Ring& = delete;
+    auto operator=(Ring&&) -> Ring& = delete;
+};
+
+// One end of an in-process link between two actors, used in place of a pair
+// of connected ZMQ_PAIR sockets. Each direction is a Ring plus a descriptor
+// which becomes readable when the ring goes from empty to non-empty, so the
+// receiving actor can block in zmq_poll alongside its sockets.
+class Pipe
+{
+public:
+    // Both ends of a new link
+    static auto Pair(const std::size_t capacity = 1024u)
+        -> std::pair<Pipe, Pipe>;
+
+    // Descriptor to poll for ZMQ_POLLIN
+    auto fd() const noexcept -> int;
+
+    // Consumes pending wake ups. Call before draining with receive().
+    auto clear() const noexcept -> void;
+    auto receive(zmq::Message& out) const noexcept -> bool;
+    // Blocks while the peer's ring is full, like a ZMQ_PAIR socket at its
+    // high water mark
+    auto send(zmq::Message&& in) const noexcept -> bool;
+    // Makes fd() readable again so a partially drained ring is revisited
+    auto wake() const noexcept -> void;
+
+    Pipe(Pipe&& rhs) noexcept;
+    auto operator=(Pipe&& rhs) noexcept -> Pipe&;
+
+    ~Pipe();
+
+private:
+    struct Shared;
+
+    std::shared_ptr<Shared> shared_;
+    bool side_;
+
+    Pipe(std::shared_ptr<Shared> shared, const bool side) noexcept;
+    Pipe() = delete;
+    Pipe(const Pipe&) = delete;
+    auto operator=(const Pipe&) -> Pipe& = delete;
+};
+
+// Where an actor finds the peer of a one-to-one link: the endpoint of a
+// ZMQ_PAIR socket or its end of a pipe
+using Endpoint = std::variant<std::string, Pipe>;
+
+// Sending side of a one-to-one link, whichever transport it uses
+class Channel
+{
+public:
+    auto send(zmq::Message&& in) const noexcept -> bool
+    {
+        if (nullptr == pipe_) { return socket_->send(std::move(in)); }
+
+        return pipe_->send(std::move(in));
+    }
+
+    Channel(const zmq::Socket& socket) noexcept
+        : socket_(&socket)
+        , pipe_(nullptr)
+    {
+    }
+    Channel(const Pipe& pipe) noexcept
+        : socket_(nullptr)
+        , pipe_(&pipe)
+    {
+    }
+
+private:
+    const zmq::Socket* socket_;
+    const Pipe* pipe_;
+};
+
+// Moves the pipe out of each endpoint which holds one, in order. The
+// endpoints still hold a (moved from) pipe afterwards so they still indicate
+// which transport each link uses.
+auto take_pipes(std::initializer_list<Endpoint*> endpoints) noexcept
+    -> std::vector<Pipe>;
+}  // namespace libsubtractive
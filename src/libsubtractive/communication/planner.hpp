@@ -0,0 +1,45 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+namespace libsubtractive
+{
+// Occupancy of the Grbl planner buffer as given by the Bf: field of the most
+// recent status report. A report is only trusted until the controller
+// acknowledges a planned line, since every acknowledgement frees a block the
+// report counted as used.
+class Planner
+{
+public:
+    // True while the latest report showed no free blocks and still applies
+    auto full() const noexcept -> bool
+    {
+        return current_ && (0u < size_) && (0u == available_);
+    }
+    auto size() const noexcept -> std::size_t { return size_; }
+
+    // Call when a planned line is acknowledged or the controller resets
+    auto expire() noexcept -> void { current_ = false; }
+    auto report(const std::size_t available) noexcept -> void
+    {
+        available_ = available;
+        size_ = std::max(size_, available);
+        current_ = true;
+    }
+    // Sets the number of blocks reported by $I
+    auto resize(const std::size_t blocks) noexcept -> void { size_ = blocks; }
+
+    Planner() noexcept
+        : size_(0)
+        , available_(0)
+        , current_(false)
+    {
+    }
+
+private:
+    std::size_t size_;
+    std::size_t available_;
+    bool current_;
+};
+}  // namespace libsubtractive
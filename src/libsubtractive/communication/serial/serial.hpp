@@ -1,7 +1,8 @@
 #pragma once
 
 #include <memory>
-#include <string_view>
+
+#include "libsubtractive/communication/pipe.hpp"
 
 namespace libsubtractive
 {
@@ -9,6 +10,8 @@ namespace zmq
 {
 class Context;
 }  // namespace zmq
+
+class Reactor;
 }  // namespace libsubtractive
 
 namespace libsubtractive
@@ -20,7 +23,8 @@ public:
 
     SerialConnection(
         const zmq::Context& zeromq,
-        const std::string_view endpoint,
+        Reactor* reactor,
+        Endpoint endpoint,
         const bool enabled);
     ~SerialConnection();
 
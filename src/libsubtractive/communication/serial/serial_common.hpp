@@ -3,26 +3,34 @@
 #include "serial.hpp"  // IWYU pragma: associated
 
 #include <zmq.h>
+#include <cstdint>
 #include <cstdlib>
-#include <iostream>
+#include <exception>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #include "libsubtractive/actor.hpp"
 #include "libsubtractive/communication/zmq/zeromq_wrapper.hpp"
+#include "libsubtractive/log.hpp"
 
 namespace libsubtractive
 {
+constexpr auto DefaultBaudRate = std::uint32_t{115200};
+
 struct SerialConnection::Imp : Actor<SerialConnection::Imp> {
     static auto Factory(
         const zmq::Context& zeromq,
-        const std::string_view endpoint,
+        Reactor* reactor,
+        Endpoint endpoint,
         const bool enabled) noexcept -> std::unique_ptr<Imp>;
 
-    virtual auto connect(const std::string_view path) -> void = 0;
+    virtual auto connect(
+        const std::string_view path,
+        const std::uint32_t baudRate) -> void = 0;
     virtual auto disconnect() -> void = 0;
     virtual auto transmit(const std::string_view data) -> void = 0;
 
@@ -38,7 +46,8 @@ protected:
     }
 
     Imp(const zmq::Context& zeromq,
-        const std::string_view endpoint,
+        Reactor* reactor,
+        Endpoint endpoint,
         const bool enabled)
         : Actor(
               zeromq,
@@ -47,18 +56,28 @@ protected:
 
                   const auto internal = RandomEndpoint();
                   auto output = Sockets{};
-                  output.emplace_back(
-                      zeromq_.Socket(ZMQ_PAIR, Direction::Connect, endpoint));
                   output.emplace_back(
                       zeromq_.Socket(ZMQ_PULL, Direction::Bind, internal));
                   output.emplace_back(
                       zeromq_.Socket(ZMQ_PUSH, Direction::Connect, internal));
 
+                  const auto* parent = std::get_if<std::string>(&endpoint);
+
+                  if (nullptr != parent) {
+                      output.emplace_back(zeromq_.Socket(
+                          ZMQ_PAIR, Direction::Connect, *parent));
+                  }
+
                   return output;
-              })
-        , internal_push_(enabled ? sockets_.at(2) : null_socket(zeromq_))
-        , internal_pull_(enabled ? sockets_.at(1) : null_socket(zeromq_))
-        , parent_socket_(enabled ? sockets_.at(0) : null_socket(zeromq_))
+              },
+              reactor,
+              enabled ? take_pipes({&endpoint}) : Pipes{})
+        , internal_push_(enabled ? sockets_.at(1) : null_socket(zeromq_))
+        , internal_pull_(enabled ? sockets_.at(0) : null_socket(zeromq_))
+        , parent_socket_(
+              (enabled && std::holds_alternative<Pipe>(endpoint))
+                  ? Channel{pipes_.front()}
+                  : Channel{enabled ? sockets_.at(2) : null_socket(zeromq_)})
     {
         init_actor();
     }
@@ -76,7 +95,7 @@ private:
     }
 
     const zmq::Socket& internal_pull_;
-    const zmq::Socket& parent_socket_;
+    const Channel parent_socket_;
 
     auto command_data_received(zmq::Message&& in) noexcept -> void
     {
@@ -94,9 +113,31 @@ private:
 
         const auto serial = in.arg(0).str();
         const auto port = in.arg(1).str();
+        // NOTE ports configured in LS_options add a baud rate after the
+        // endpoint argument
+        const auto baud = ((3 < in.arg_count()) &&
+                           (sizeof(std::uint32_t) == in.arg(3).size()))
+                              ? in.arg(3).as<std::uint32_t>()
+                              : std::uint32_t{0};
+
+        // NOTE ports configured by hand may not exist or may reject the baud
+        // rate, which leaves the machine disconnected rather than ending the
+        // process
+        try {
+            connect(port, (0 == baud) ? DefaultBaudRate : baud);
+        } catch (const std::exception& e) {
+            log::error(
+                "Failed to connect ", serial, " via ", port, ": ", e.what());
+
+            try {
+                disconnect();
+            } catch (...) {
+            }
+
+            return;
+        }
 
-        connect(port);
-        std::cout << "Device " << serial << " connected via: " << port << '\n';
+        log::info("Device ", serial, " connected via: ", port);
     }
     auto command_usb_device_removed(zmq::Message&& in) noexcept -> void
     {
@@ -106,8 +147,7 @@ private:
         const auto port = in.arg(1).str();
 
         disconnect();
-        std::cout << "Device " << serial << " no longer available via: " << port
-                  << '\n';
+        log::info("Device ", serial, " no longer available via: ", port);
     }
     auto process_command(zmq::Message&& command) noexcept -> bool
     {
@@ -146,8 +186,15 @@ private:
             case Command::Invalid:
             case Command::ListDevices:
             case Command::Subscribe:
+            case Command::SubscribeEvents:
             case Command::Unsubscribe:
             case Command::ExecuteProgram:
+            case Command::ResumeProgram:
+            case Command::AnalyzeProgram:
+            case Command::EventsDropped:
+            case Command::ProgramAnalysis:
+            case Command::StatusReport:
+            case Command::ProgramProgress:
             case Command::PushDeviceRemoved:
             case Command::PushDeviceAdded:
             case Command::ListDevicesReply:
@@ -167,9 +214,10 @@ private:
 
 SerialConnection::SerialConnection(
     const zmq::Context& zeromq,
-    const std::string_view endpoint,
+    Reactor* reactor,
+    Endpoint endpoint,
     const bool enabled)
-    : imp_(Imp::Factory(zeromq, endpoint, enabled))
+    : imp_(Imp::Factory(zeromq, reactor, std::move(endpoint), enabled))
 {
     if (!imp_) {
         throw std::runtime_error("Failed to initialize SerialConnection");
@@ -4,31 +4,52 @@
 #include <boost/bind/bind.hpp>  // IWYU pragma: keep
 #include <boost/bind/mem_fn.hpp>
 #include <boost/system/error_code.hpp>
-#include <cctype>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <iterator>
+#include <string>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #include "libsubtractive/communication/serial/serial.hpp"
+#include "libsubtractive/log.hpp"
+#include "libsubtractive/protocol/Grbl.hpp"
+#include "libsubtractive/reactor.hpp"
 
 namespace libsubtractive
 {
+constexpr auto ReceiveBufferSize = std::size_t{1024};
+// Write coalescing is reported at most this often while a port is busy, and
+// once more when it disconnects
+constexpr auto WriteReportInterval = std::chrono::seconds{60};
+
 struct Nonwindows final : virtual public SerialConnection::Imp {
-    auto connect(const std::string_view path) -> void final
+    auto connect(const std::string_view path, const std::uint32_t baudRate)
+        -> void final
     {
         disconnect();
-        asio_context_ = std::make_unique<boost::asio::io_context>();
-        work_ = std::make_unique<boost::asio::io_context::work>(*asio_context_);
-        asio_thread_ = std::thread([this]() { asio_context_->run(); });
+
+        if (nullptr == reactor_) {
+            asio_context_ = std::make_unique<boost::asio::io_context>();
+            work_ = std::make_unique<boost::asio::io_context::work>(
+                *asio_context_);
+            asio_thread_ = std::thread([this]() { asio_context_->run(); });
+        }
 
         try {
             serial_port_ = std::make_unique<boost::asio::serial_port>(
-                *asio_context_, std::string{path});
+                io_context(), std::string{path});
         } catch (...) {
             throw std::runtime_error("Serial port does not exist");
         }
 
         try {
             using serial = boost::asio::serial_port_base;
-            serial_port_->set_option(serial::baud_rate(115200));
+            serial_port_->set_option(serial::baud_rate(baudRate));
             serial_port_->set_option(serial::character_size(8));
             serial_port_->set_option(serial::parity(serial::parity::none));
             serial_port_->set_option(serial::stop_bits(serial::stop_bits::one));
@@ -36,10 +57,17 @@ struct Nonwindows final : virtual public SerialConnection::Imp {
             throw std::runtime_error("Failed to configure serial port");
         }
 
-        get_next_byte();
+        received_ = 0;
+        boost::asio::post(io_context(), [this]() { get_next_chunk(); });
     }
     auto disconnect() -> void final
     {
+        if (nullptr != reactor_) {
+            disconnect_shared();
+
+            return;
+        }
+
         work_.reset();
 
         if (asio_context_) {
@@ -50,65 +78,150 @@ struct Nonwindows final : virtual public SerialConnection::Imp {
 
         if (asio_thread_.joinable()) { asio_thread_.join(); }
 
+        clear_write_queue();
         serial_port_.reset();
         asio_context_.reset();
     }
     auto transmit(const std::string_view data) -> void final
     {
-        std::cout << __FUNCTION__ << ": " << data << '\n';
-        boost::asio::write(
-            *serial_port_, boost::asio::buffer(data.data(), data.size()));
+        if (false == bool(serial_port_)) { return; }
+
+        const auto realtime =
+            (1 == data.size()) && grbl::is_realtime(data.front());
+        boost::asio::post(
+            io_context(),
+            [this, realtime, bytes = std::string{data}]() mutable {
+                auto& queue = realtime ? realtime_queue_ : write_queue_;
+                queue.emplace_back(std::move(bytes));
+                write_next();
+            });
     }
 
     Nonwindows(
         const zmq::Context& zeromq,
-        const std::string_view endpoint,
+        Reactor* reactor,
+        Endpoint endpoint,
         const bool enabled)
-        : SerialConnection::Imp(zeromq, endpoint, enabled)
+        : SerialConnection::Imp(zeromq, reactor, std::move(endpoint), enabled)
         , asio_context_()
         , serial_port_()
         , receive_buffer_()
+        , received_(0)
+        , realtime_queue_()
+        , write_queue_()
+        , in_flight_()
+        , write_buffers_()
+        , writing_(false)
+        , lines_written_(0)
+        , bytes_written_(0)
+        , writes_(0)
+        , write_reported_(std::chrono::steady_clock::now())
         , work_()
         , asio_thread_()
-        , next_byte_()
     {
-        receive_buffer_.reserve(256);
     }
     ~Nonwindows() final { shutdown(); }
 
 private:
     mutable std::unique_ptr<boost::asio::io_context> asio_context_;
     mutable std::unique_ptr<boost::asio::serial_port> serial_port_;
-    mutable std::vector<char> receive_buffer_;
+    // NOTE holds at most one partial line followed by unprocessed input. Lines
+    // longer than the buffer are delivered in buffer-sized pieces.
+    std::array<char, ReceiveBufferSize> receive_buffer_;
+    std::size_t received_;
+    // NOTE everything from realtime_queue_ to write_reported_ is only accessed
+    // from the thread running io_context()
+    std::vector<std::string> realtime_queue_;
+    std::vector<std::string> write_queue_;
+    std::vector<std::string> in_flight_;
+    std::vector<boost::asio::const_buffer> write_buffers_;
+    bool writing_;
+    std::size_t lines_written_;
+    std::size_t bytes_written_;
+    std::size_t writes_;
+    std::chrono::steady_clock::time_point write_reported_;
     std::unique_ptr<boost::asio::io_context::work> work_;
     std::thread asio_thread_;
-    char next_byte_;
 
+    static auto is_printable(const char byte) noexcept -> bool
+    {
+        return 0x5f > static_cast<unsigned char>(byte - 0x20);
+    }
+
+    auto clear_write_queue() noexcept -> void
+    {
+        report_writes();
+        realtime_queue_.clear();
+        write_queue_.clear();
+        in_flight_.clear();
+        write_buffers_.clear();
+        writing_ = false;
+    }
+    // NOTE the io_context is shared with every other serial port on the
+    // reactor so it must not be stopped. Closing the port aborts the
+    // outstanding read and the completion handler for the abort is queued
+    // before the handler which signals completion.
+    auto disconnect_shared() noexcept -> void
+    {
+        if (false == bool(serial_port_)) { return; }
+
+        auto done = std::promise<void>{};
+        boost::asio::post(io_context(), [&]() {
+            auto error = boost::system::error_code{};
+            serial_port_->close(error);
+            clear_write_queue();
+            boost::asio::post(io_context(), [&]() { done.set_value(); });
+        });
+        done.get_future().wait();
+        serial_port_.reset();
+    }
+    // Removes \r and any other non-printable bytes in place and sends the
+    // remainder as a single frame
+    auto flush_line(char* begin, char* end) noexcept -> void
+    {
+        end = std::remove_if(begin, end, [](const auto byte) {
+            return false == is_printable(byte);
+        });
+        const auto size = static_cast<std::size_t>(std::distance(begin, end));
+
+        if (0 == size) { return; }
+
+        auto message = zeromq_.Command(Command::DataReceived);
+        log::debug("receive: ", std::string_view{begin, size});
+        message.emplace_back(begin, size);
+        internal_push_.send(std::move(message));
+    }
     auto flush_receive_buffer() noexcept -> void
     {
-        if (1 < receive_buffer_.size()) {
-            auto data = std::vector<char>{};
-            data.reserve(receive_buffer_.size());
-
-            for (const auto& byte : receive_buffer_) {
-                if (std::isprint(byte)) { data.emplace_back(byte); }
-            }
-
-            auto message = zeromq_.Command(Command::DataReceived);
-            std::cout << "receive: " << std::string{data.data(), data.size()}
-                      << '\n';
-            message.emplace_back(data.data(), data.size());
-            internal_push_.send(std::move(message));
+        auto* begin = receive_buffer_.data();
+        auto* const end = begin + received_;
+
+        while (begin < end) {
+            auto* const eol = static_cast<char*>(std::memchr(
+                begin, '\n', static_cast<std::size_t>(end - begin)));
+
+            if (nullptr == eol) { break; }
+
+            flush_line(begin, eol);
+            begin = eol + 1;
         }
 
-        receive_buffer_.clear();
-        next_byte_ = {};
+        received_ = static_cast<std::size_t>(end - begin);
+
+        if (receive_buffer_.size() == received_) {
+            flush_line(begin, end);
+            received_ = 0;
+        } else if (0 < received_) {
+            std::memmove(receive_buffer_.data(), begin, received_);
+        }
     }
-    auto get_next_byte() noexcept -> void
+    auto get_next_chunk() noexcept -> void
     {
-        if (serial_port_ && work_) {
+        if (serial_port_ && serial_port_->is_open()) {
             serial_port_->async_read_some(
-                boost::asio::buffer(&next_byte_, sizeof(next_byte_)),
+                boost::asio::buffer(
+                    receive_buffer_.data() + received_,
+                    receive_buffer_.size() - received_),
                 boost::bind(
                     &Nonwindows::read_cb,
                     this,
@@ -116,29 +229,101 @@ private:
                     boost::asio::placeholders::bytes_transferred));
         }
     }
+    auto io_context() noexcept -> boost::asio::io_context&
+    {
+        return (nullptr == reactor_) ? *asio_context_ : reactor_->io_context();
+    }
     auto read_cb(
         const boost::system::error_code& error,
         const std::size_t bytes) noexcept -> void
     {
+        if (boost::asio::error::operation_aborted == error) { return; }
+
         if ((0 < bytes) && !error) {
-            if ('\r' == next_byte_) {
-                next_byte_ = {};
-            } else {
-                receive_buffer_.emplace_back(next_byte_);
-            }
+            received_ += bytes;
+            flush_receive_buffer();
         }
 
-        if ('\n' == next_byte_) { flush_receive_buffer(); }
+        get_next_chunk();
+    }
+    // Logs how many lines were combined into each write since the previous
+    // report
+    auto report_writes() noexcept -> void
+    {
+        write_reported_ = std::chrono::steady_clock::now();
+
+        if (0 == writes_) { return; }
+
+        log::info(
+            "Serial: ",
+            lines_written_,
+            " lines, ",
+            bytes_written_,
+            " bytes in ",
+            writes_,
+            " writes");
+        lines_written_ = 0;
+        bytes_written_ = 0;
+        writes_ = 0;
+    }
+    // Gathers everything queued since the last write began into a single
+    // scatter/gather write. Realtime bytes go first, in the order received.
+    auto write_next() noexcept -> void
+    {
+        if (writing_ || false == bool(serial_port_)) { return; }
+
+        if (realtime_queue_.empty() && write_queue_.empty()) { return; }
+
+        in_flight_.clear();
+        in_flight_.swap(realtime_queue_);
+        std::move(
+            write_queue_.begin(),
+            write_queue_.end(),
+            std::back_inserter(in_flight_));
+        write_queue_.clear();
+        write_buffers_.clear();
+
+        for (const auto& bytes : in_flight_) {
+            write_buffers_.emplace_back(bytes.data(), bytes.size());
+        }
+
+        writing_ = true;
+        boost::asio::async_write(
+            *serial_port_,
+            write_buffers_,
+            boost::bind(
+                &Nonwindows::write_cb,
+                this,
+                boost::asio::placeholders::error,
+                boost::asio::placeholders::bytes_transferred));
+    }
+    auto write_cb(
+        const boost::system::error_code& error,
+        const std::size_t bytes) noexcept -> void
+    {
+        if (boost::asio::error::operation_aborted == error) { return; }
+
+        writing_ = false;
+        lines_written_ += in_flight_.size();
+        bytes_written_ += bytes;
+        ++writes_;
+
+        if (std::chrono::steady_clock::now() >=
+            write_reported_ + WriteReportInterval) {
+            report_writes();
+        }
 
-        get_next_byte();
+        write_next();
     }
 };
 
 auto SerialConnection::Imp::Factory(
     const zmq::Context& zeromq,
-    const std::string_view endpoint,
+    Reactor* reactor,
+    Endpoint endpoint,
     const bool enabled) noexcept -> std::unique_ptr<Imp>
 {
-    return std::make_unique<Nonwindows>(zeromq, endpoint, enabled);
+    return std::make_unique<Nonwindows>(
+        zeromq, reactor, std::move(endpoint), enabled);
 }
 }  // namespace libsubtractive
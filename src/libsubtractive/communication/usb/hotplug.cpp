@@ -10,12 +10,18 @@
 namespace libsubtractive
 {
 constexpr auto MaxUSBInterfaces = std::uint8_t{1};
+// Interval between enumerations when HotplugMonitor is unavailable
+constexpr auto PollInterval = std::chrono::milliseconds{500};
 
-Hotplug::Hotplug(const zmq::Context& zeromq, const bool enabled)
+Hotplug::Hotplug(
+    const zmq::Context& zeromq,
+    const std::string& endpoint,
+    const bool enabled)
     : zeromq_(zeromq)
-    , socket_(zeromq_.Socket(ZMQ_PUSH, Direction::Connect, ContextEndpoint()))
+    , socket_(zeromq_.Socket(ZMQ_PUSH, Direction::Connect, endpoint))
     , running_(enabled)
     , device_list_()
+    , monitor_(enabled ? HotplugMonitor::Factory() : nullptr)
     , thread_([this] { thread(); })
 {
 }
@@ -86,11 +92,18 @@ auto Hotplug::get_port_path(
     return true;
 }
 
+// Devices are enumerated once at startup and again whenever the monitor
+// reports a change, so the commands sent are the same as when polling
 auto Hotplug::thread() noexcept -> void
 {
     while (running_) {
         enumerate_usb();
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+        if (monitor_) {
+            monitor_->wait();
+        } else {
+            std::this_thread::sleep_for(PollInterval);
+        }
     }
 }
 
@@ -98,6 +111,8 @@ Hotplug::~Hotplug()
 {
     running_ = false;
 
+    if (monitor_) { monitor_->stop(); }
+
     if (thread_.joinable()) { thread_.join(); }
 }
 }  // namespace libsubtractive
@@ -3,9 +3,11 @@
 #include <atomic>
 #include <cstdint>
 #include <map>
+#include <memory>
 #include <string>
 #include <thread>
 
+#include "libsubtractive/communication/usb/monitor.hpp"
 #include "libsubtractive/communication/zmq/zeromq_wrapper.hpp"
 
 namespace libusbp
@@ -18,7 +20,11 @@ namespace libsubtractive
 class Hotplug
 {
 public:
-    Hotplug(const zmq::Context& zeromq, const bool enabled);
+    // Device changes are pushed to endpoint
+    Hotplug(
+        const zmq::Context& zeromq,
+        const std::string& endpoint,
+        const bool enabled);
 
     ~Hotplug();
 
@@ -31,6 +37,8 @@ private:
     zmq::Socket socket_;
     std::atomic_bool running_;
     DeviceMap device_list_;
+    // Null when devices are polled for instead
+    std::unique_ptr<HotplugMonitor> monitor_;
     std::thread thread_;
 
     static auto get_usb_address(const libusbp::device& device) noexcept
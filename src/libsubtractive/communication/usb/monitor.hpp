@@ -0,0 +1,34 @@
+#pragma once
+
+#include <memory>
+
+namespace libsubtractive
+{
+// Notification of serial devices being plugged in or removed, so Hotplug only
+// enumerates devices when something changed
+class HotplugMonitor
+{
+public:
+    // Returns nullptr if notifications are not available on this platform or
+    // could not be set up, in which case Hotplug polls instead
+    static auto Factory() noexcept -> std::unique_ptr<HotplugMonitor>;
+
+    // Blocks until a device has been added or removed or stop() is called.
+    // May also return spuriously.
+    virtual auto wait() noexcept -> void = 0;
+    // Makes the current and every later call to wait() return immediately.
+    // Safe to call from any thread.
+    virtual auto stop() noexcept -> void = 0;
+
+    virtual ~HotplugMonitor() = default;
+
+protected:
+    HotplugMonitor() = default;
+
+private:
+    HotplugMonitor(const HotplugMonitor&) = delete;
+    HotplugMonitor(HotplugMonitor&&) = delete;
+    auto operator=(const HotplugMonitor&) -> HotplugMonitor& = delete;
+    auto operator=(HotplugMonitor&&) -> HotplugMonitor& = delete;
+};
+}  // namespace libsubtractive
@@ -0,0 +1,9 @@
+#include "libsubtractive/communication/usb/monitor.hpp"  // IWYU pragma: associated
+
+namespace libsubtractive
+{
+auto HotplugMonitor::Factory() noexcept -> std::unique_ptr<HotplugMonitor>
+{
+    return {};
+}
+}  // namespace libsubtractive
@@ -0,0 +1,145 @@
+#include "libsubtractive/communication/usb/monitor.hpp"  // IWYU pragma: associated
+
+#include <libudev.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+#include "libsubtractive/log.hpp"
+
+namespace libsubtractive
+{
+// Plugging in one device produces several events (USB device, interfaces, tty)
+// which are handled together once none has arrived for this long
+constexpr auto SettleTime = std::chrono::milliseconds{100};
+
+class UdevMonitor final : public HotplugMonitor
+{
+public:
+    static auto Factory() noexcept -> std::unique_ptr<HotplugMonitor>
+    {
+        auto* context = udev_new();
+
+        if (nullptr == context) { return {}; }
+
+        auto* monitor = udev_monitor_new_from_netlink(context, "udev");
+        const auto wake = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        const auto ready =
+            (nullptr != monitor) && (0 <= wake) &&
+            (0 <= udev_monitor_filter_add_match_subsystem_devtype(
+                      monitor, "tty", nullptr)) &&
+            (0 <= udev_monitor_filter_add_match_subsystem_devtype(
+                      monitor, "usb", "usb_device")) &&
+            (0 <= udev_monitor_enable_receiving(monitor));
+
+        if (false == ready) {
+            if (0 <= wake) { ::close(wake); }
+
+            if (nullptr != monitor) { udev_monitor_unref(monitor); }
+
+            udev_unref(context);
+
+            return {};
+        }
+
+        return std::unique_ptr<HotplugMonitor>{
+            new UdevMonitor{context, monitor, wake}};
+    }
+
+    auto wait() noexcept -> void final
+    {
+        // NOTE block until the first event, then until the burst is over
+        auto timeout = -1;
+
+        while (true) {
+            auto items = std::array<pollfd, 2>{
+                {{udev_monitor_get_fd(monitor_), POLLIN, 0},
+                 {wake_, POLLIN, 0}}};
+            const auto events = ::poll(items.data(), items.size(), timeout);
+
+            if (0 != items.at(1).revents) { return; }
+
+            if (0 > events) {
+                if (EINTR == errno) { continue; }
+
+                return;
+            }
+
+            if (0 == events) { return; }
+
+            if (receive()) {
+                timeout = static_cast<int>(SettleTime.count());
+            }
+        }
+    }
+    auto stop() noexcept -> void final
+    {
+        const auto value = std::uint64_t{1};
+
+        if (0 > ::write(wake_, &value, sizeof(value))) {
+            log::error(
+                "Failed to stop hotplug monitor: ", std::strerror(errno));
+        }
+    }
+
+    ~UdevMonitor() final
+    {
+        ::close(wake_);
+        udev_monitor_unref(monitor_);
+        udev_unref(context_);
+    }
+
+private:
+    udev* const context_;
+    udev_monitor* const monitor_;
+    const int wake_;
+
+    // Returns true if any pending event added or removed a device
+    auto receive() noexcept -> bool
+    {
+        auto output{false};
+
+        while (auto* device = udev_monitor_receive_device(monitor_)) {
+            const auto* action = udev_device_get_action(device);
+
+            if (nullptr != action) {
+                output |= (0 == std::strcmp(action, "add")) ||
+                          (0 == std::strcmp(action, "remove"));
+            }
+
+            udev_device_unref(device);
+        }
+
+        return output;
+    }
+
+    UdevMonitor(udev* context, udev_monitor* monitor, const int wake) noexcept
+        : HotplugMonitor()
+        , context_(context)
+        , monitor_(monitor)
+        , wake_(wake)
+    {
+    }
+    UdevMonitor() = delete;
+    UdevMonitor(const UdevMonitor&) = delete;
+    UdevMonitor(UdevMonitor&&) = delete;
+    auto operator=(const UdevMonitor&) -> UdevMonitor& = delete;
+    auto operator=(UdevMonitor&&) -> UdevMonitor& = delete;
+};
+
+auto HotplugMonitor::Factory() noexcept -> std::unique_ptr<HotplugMonitor>
+{
+    auto output = UdevMonitor::Factory();
+
+    if (false == bool(output)) {
+        log::warning("udev monitor unavailable, polling for USB devices");
+    }
+
+    return output;
+}
+}  // namespace libsubtractive
@@ -1,9 +1,10 @@
 #include "zeromq_wrapper.hpp"  // IWYU pragma: associated
 
 #include <atomic>
-#include <iostream>
 #include <iterator>
 
+#include "libsubtractive/log.hpp"
+
 namespace libsubtractive
 {
 constexpr std::string_view EndpointNamespace{"inproc://libsubtractive/"};
@@ -59,7 +60,7 @@ auto Context::Response(const Message& request) const noexcept -> zmq::Message
             break;
         }
 
-        output.emplace_back(frame.data(), frame.size());
+        output.emplace_back(frame);
     }
 
     if (false == body) { output.clear(); }
@@ -133,6 +134,21 @@ auto Message::change_type(const Command newType) noexcept -> bool
     return true;
 }
 
+auto Message::forward(const Identity& recipient) const noexcept -> Message
+{
+    auto output = Message{};
+
+    if (false == parse()) { return output; }
+
+    const auto body = std::distance(seperator_, cend());
+    output.reserve(1u + static_cast<std::size_t>(body));
+    output.emplace_back(recipient.data(), recipient.size());
+
+    for (auto i{seperator_}; i != cend(); ++i) { output.emplace_back(*i); }
+
+    return output;
+}
+
 auto Message::identity() const -> std::vector<std::byte>
 {
     const auto& frame = at(0);
@@ -200,7 +216,7 @@ auto Socket::rcvmore(void* socket) noexcept -> bool
 
     if (0 > zmq_getsockopt(socket, ZMQ_RCVMORE, &data, &size)) {
         const auto error = zmq_errno();
-        std::cerr << zmq_strerror(error) << '\n';
+        log::error(zmq_strerror(error));
 
         return false;
     }
@@ -221,7 +237,7 @@ auto Socket::receive(void* socket, Message& output) noexcept -> bool
 
         if (0 > zmq_msg_recv(frame, socket, ZMQ_DONTWAIT)) {
             const auto error = zmq_errno();
-            std::cerr << zmq_strerror(error) << '\n';
+            log::error(zmq_strerror(error));
 
             return false;
         }
@@ -251,7 +267,7 @@ auto Socket::send(Message&& input) const noexcept -> bool
 
         if (0 > zmq_msg_send(frame, data_, more)) {
             const auto error = zmq_errno();
-            std::cerr << zmq_strerror(error) << '\n';
+            log::error(zmq_strerror(error));
 
             return false;
         } else {
@@ -261,4 +277,21 @@ auto Socket::send(Message&& input) const noexcept -> bool
 
     return true;
 }
+
+auto Socket::send_nonblocking(Message& input) const noexcept -> int
+{
+    auto counter = std::size_t{0};
+
+    for (auto& frame : input) {
+        const auto more = (++counter < input.size()) ? ZMQ_SNDMORE : 0;
+
+        if (0 > zmq_msg_send(frame, data_, ZMQ_DONTWAIT | more)) {
+            return zmq_errno();
+        }
+
+        frame.release();
+    }
+
+    return 0;
+}
 }  // namespace libsubtractive::zmq
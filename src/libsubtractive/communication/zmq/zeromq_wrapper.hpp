@@ -45,6 +45,13 @@ enum class Command : std::uint8_t {
     GrblCycleToggle = LS_GRBLCYCLETOGGLE,
     GrblFeedHold = LS_GRBLFEEDHOLD,
     GrblJogCancel = LS_GRBLJOGCANCEL,
+    AnalyzeProgram = LS_ANALYZE_PROGRAM,
+    ResumeProgram = LS_RESUME_PROGRAM,
+    SubscribeEvents = LS_SUBSCRIBE_EVENTS,
+    EventsDropped = LS_EVENTSDROPPED,
+    ProgramAnalysis = LS_PROGRAMANALYSIS,
+    StatusReport = LS_STATUSREPORT,
+    ProgramProgress = LS_PROGRAMPROGRESS,
     PushDeviceRemoved = LS_DEVICEREMOVED,
     PushDeviceAdded = LS_DEVICEADDED,
     ListDevicesReply = LS_LISTDEVICES_REPLY,
@@ -97,6 +104,9 @@ private:
     auto operator=(Context &&) -> Context& = delete;
 };
 
+// NOTE copies share the payload with the original via zmq_msg_copy and moves
+// transfer ownership via zmq_msg_move so neither copies message contents.
+// Modifying the contents of a copied frame through data() modifies every copy.
 class Frame
 {
 public:
@@ -153,24 +163,24 @@ public:
     {
     }
     Frame(const Frame& rhs) noexcept
-        : Frame(rhs.data(), rhs.size())
+        : data_()
     {
+        zmq_msg_init(&data_);
+        zmq_msg_copy(&data_, const_cast<zmq_msg_t*>(&rhs.data_));
     }
     Frame(Frame&& rhs) noexcept
-        : Frame(rhs.data(), rhs.size())
+        : data_()
     {
+        zmq_msg_init(&data_);
+        zmq_msg_move(&data_, &rhs.data_);
     }
 
-    auto operator=(Frame&& rhs) -> Frame&
+    auto operator=(Frame&& rhs) noexcept -> Frame&
     {
         if (this != &rhs) {
-            zmq_msg_close(&data_);
-
-            if (0 != zmq_msg_init(&data_)) {
-                throw std::runtime_error("Failed to initialize zmq frame");
-            }
-
-            std::memcpy(zmq_msg_data(&data_), rhs.data(), rhs.size());
+            // NOTE zmq_msg_move releases the previous contents of data_
+            zmq_msg_move(&data_, &rhs.data_);
+            sent_ = false;
         }
 
         return *this;
@@ -198,6 +208,9 @@ public:
 
     auto arg(const std::size_t index) const -> const Frame&;
     auto arg_count() const noexcept -> std::size_t;
+    // Returns the type and arguments of this message addressed to recipient.
+    // The frames share their payloads with this message.
+    auto forward(const Identity& recipient) const noexcept -> Message;
     auto identity() const -> Identity;
     auto type() const noexcept -> Command;
 
@@ -219,6 +232,10 @@ public:
 
     auto receive(Message& output) const noexcept -> bool;
     auto send(Message&& input) const noexcept -> bool;
+    // Returns 0 or the zmq error which prevented input from being sent without
+    // blocking. Input is left intact on failure, which assumes only the first
+    // frame can fail, as is the case for ROUTER sockets.
+    auto send_nonblocking(Message& input) const noexcept -> int;
 
     Socket(const Context& context, const int type)
         : data_(zmq_socket(context, type))
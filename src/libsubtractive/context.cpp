@@ -3,23 +3,139 @@
 #include <zmq.h>
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstdint>
-#include <iostream>
+#include <cstring>
+#include <memory>
 #include <mutex>
+#include <stdexcept>
 #include <string_view>
 #include <tuple>
 #include <type_traits>
 #include <vector>
 
+#include "libsubtractive/gcode/analyzer.hpp"
 #include "libsubtractive/libsubtractive.hpp"
+#include "libsubtractive/log.hpp"
 
 std::mutex init_mutex_{};
 
+namespace libsubtractive
+{
+constexpr auto AlarmPrefix = std::string_view{"ALARM"};
+// Delay before sending to subscribers which were not accepting messages
+constexpr auto OutboxRetryInterval = std::chrono::milliseconds{10};
+
+// NOTE char_traits<char> compares as unsigned char, so IDs and their views
+// are ordered alike
+auto view(const std::vector<std::byte>& id) noexcept -> std::string_view;
+auto view(const std::vector<std::byte>& id) noexcept -> std::string_view
+{
+    return {reinterpret_cast<const char*>(id.data()), id.size()};
+}
+
+auto set_option(const zmq::Socket& socket, const int option, const int value)
+    -> void;
+auto set_option(const zmq::Socket& socket, const int option, const int value)
+    -> void
+{
+    if (0 != zmq_setsockopt(socket, option, &value, sizeof(value))) {
+        log::error(
+            "Failed to set router option ",
+            option,
+            ": ",
+            zmq_strerror(zmq_errno()));
+    }
+}
+
+// Options apply to connections accepted after they are set, so they are set
+// before any endpoint is bound. Only failure to bind the internal endpoint is
+// fatal.
+auto bind_router(const zmq::Socket& router, const LS_options& options) -> void;
+auto bind_router(const zmq::Socket& router, const LS_options& options) -> void
+{
+    // NOTE fail sends to subscribers which are full or gone instead of
+    // silently discarding them, so Outbox can account for them
+    set_option(router, ZMQ_ROUTER_MANDATORY, 1);
+
+    if (0 < options.router_hwm_) {
+        set_option(router, ZMQ_SNDHWM, options.router_hwm_);
+        set_option(router, ZMQ_RCVHWM, options.router_hwm_);
+    }
+
+    if (0 < options.tcp_keepalive_s_) {
+        set_option(router, ZMQ_TCP_KEEPALIVE, 1);
+        set_option(router, ZMQ_TCP_KEEPALIVE_IDLE, options.tcp_keepalive_s_);
+        set_option(router, ZMQ_TCP_KEEPALIVE_INTVL, options.tcp_keepalive_s_);
+        set_option(router, ZMQ_TCP_KEEPALIVE_CNT, 3);
+    }
+
+    if (0 != zmq_bind(router, ContextEndpoint().c_str())) {
+        throw std::runtime_error("Failed to bind context endpoint");
+    }
+
+    for (auto i = std::size_t{0}; i < options.endpoint_count_; ++i) {
+        const auto* endpoint = options.endpoints_[i];
+
+        if ((nullptr == endpoint) || (0 == std::strlen(endpoint))) {
+            continue;
+        }
+
+        if (0 == zmq_bind(router, endpoint)) {
+            log::info("Accepting clients on ", endpoint);
+        } else {
+            log::error(
+                "Failed to bind ", endpoint, ": ", zmq_strerror(zmq_errno()));
+        }
+    }
+}
+
+auto event(const zmq::Message& in) noexcept -> std::uint32_t;
+auto event(const zmq::Message& in) noexcept -> std::uint32_t
+{
+    const auto type = in.type();
+
+    if (Command::ResponseReceived == type) { return LS_EVENT_RESPONSES; }
+
+    if (Command::StatusReport == type) { return LS_EVENT_STATUS; }
+
+    if (Command::ProgramProgress == type) { return LS_EVENT_PROGRESS; }
+
+    if (Command::GrblPushReceived == type) {
+        const auto alarm = (1 < in.arg_count()) &&
+                           (0 == in.arg(1).str().rfind(AlarmPrefix, 0));
+
+        return alarm ? LS_EVENT_ALARMS : LS_EVENT_PUSHES;
+    }
+
+    return LS_EVENT_ALL;
+}
+}  // namespace libsubtractive
+
 extern "C" {
 LS_options libsubtractive_default_options()
 {
     auto output = LS_options{};
     output.init_usb_ = true;
+    output.reactor_threads_ = 0;
+    output.status_interval_active_ms_ = 0;
+    output.status_interval_idle_ms_ = 0;
+    output.compact_gcode_ = false;
+    output.compact_precision_ = -1;
+    output.path_tolerance_ = 0.0;
+    output.analyzer_threads_ = 0;
+    output.program_cache_dir_ = nullptr;
+    output.program_cache_size_ = std::uint64_t{1} << 30u;
+    output.ring_transport_ = false;
+    output.log_level_ = LS_LOG_INFO;
+    output.log_file_ = nullptr;
+    output.serial_ports_ = nullptr;
+    output.serial_port_count_ = 0;
+    output.subscriber_queue_limit_ = 1024;
+    output.endpoints_ = nullptr;
+    output.endpoint_count_ = 0;
+    output.router_hwm_ = 0;
+    output.tcp_keepalive_s_ = 0;
 
     return output;
 }
@@ -37,6 +153,10 @@ void* libsubtractive_init_context(const LS_options* options)
 
         auto opt = (nullptr == options) ? &defaultOpts : options;
 
+        // NOTE before any actor starts so every record follows the options
+        libsubtractive::log::configure(
+            static_cast<libsubtractive::log::Level>(opt->log_level_),
+            opt->log_file_);
         singleton.store(new libsubtractive::Context(*opt));
     }
 
@@ -50,6 +170,12 @@ void libsubtractive_close_context()
 
     if (nullptr != context) { delete context; }
 }
+
+void libsubtractive_set_log_level(LS_LogLevel level)
+{
+    libsubtractive::log::level_.store(
+        static_cast<libsubtractive::log::Level>(level));
+}
 }
 
 namespace libsubtractive
@@ -57,26 +183,188 @@ namespace libsubtractive
 std::atomic<Context*> Context::singleton_{};
 
 Context::Context(const LS_options& options)
+    : Context(options, RandomEndpoint(), RandomEndpoint())
+{
+}
+
+// NOTE device changes arrive on a socket of their own so the router only
+// carries client requests
+Context::Context(
+    const LS_options& options,
+    const std::string& analysisEndpoint,
+    const std::string& hotplugEndpoint)
     : ZMQParent()
     , Actor(
           zmq_context_,
           [&]() -> auto {
               auto output = Sockets{};
-              output.emplace_back(zeromq_.Socket(
-                  ZMQ_ROUTER, Direction::Bind, ContextEndpoint()));
+              bind_router(
+                  output.emplace_back(zeromq_.Socket(ZMQ_ROUTER)), options);
+              output.emplace_back(
+                  zeromq_.Socket(ZMQ_PAIR, Direction::Bind, analysisEndpoint));
+              output.emplace_back(
+                  zeromq_.Socket(ZMQ_PULL, Direction::Bind, hotplugEndpoint));
 
               return output;
           })
+    , options_(options)
     , router_(sockets_.at(0))
-    , hotplug_(zeromq_, options.init_usb_)
+    , analysis_socket_(sockets_.at(1))
+    , hotplug_(zeromq_, hotplugEndpoint, options.init_usb_)
+    , analysis_(zeromq_, options_, analysisEndpoint)
+    , reactor_(
+          (0 < options.reactor_threads_)
+              ? std::make_unique<Reactor>(zeromq_, options.reactor_threads_)
+              : nullptr)
     , devices_()
     , device_subscribers_()
-    , machine_subscribers_()
-    , recognized_devices_()
+    , outboxes_()
+    , unreachable_()
 {
+    add_serial_ports();
     init_actor();
 }
 
+// Clients, which may be remote when endpoints are bound, are only allowed the
+// requests of the public API and only with the arguments their handlers read.
+// Anything else is dropped rather than reaching the abort() which guards the
+// same messages from inside the library.
+auto Context::accept_command(const void* socket, const zmq::Message& in)
+    const noexcept -> bool
+{
+    if (static_cast<void*>(router_) != socket) { return true; }
+
+    const auto type = in.type();
+    const auto args = in.arg_count();
+    auto valid{false};
+
+    switch (type) {
+        case Command::ListDevices:
+        case Command::Subscribe:
+        case Command::Unsubscribe: {
+            valid = true;
+        } break;
+        case Command::GrblHelp:
+        case Command::GrblStatus:
+        case Command::GrblSettings:
+        case Command::GrblVersion:
+        case Command::GrblHome:
+        case Command::GrblParams:
+        case Command::GrblParserState:
+        case Command::GrblStartupBlocks:
+        case Command::GrblCheckModeToggle:
+        case Command::GrblResetAlarm:
+        case Command::GrblSoftReset:
+        case Command::GrblCycleToggle:
+        case Command::GrblFeedHold:
+        case Command::GrblJogCancel: {
+            valid = (1 <= args);
+        } break;
+        case Command::SendGcode:
+        case Command::SubscribeEvents: {
+            valid = (2 <= args);
+        } break;
+        case Command::ExecuteProgram:
+        case Command::AnalyzeProgram: {
+            valid = (3 <= args);
+        } break;
+        case Command::ResumeProgram: {
+            valid = (4 <= args) && (sizeof(std::uint64_t) == in.arg(3).size());
+        } break;
+        case Command::Invalid:
+        case Command::EventsDropped:
+        case Command::ProgramAnalysis:
+        case Command::StatusReport:
+        case Command::ProgramProgress:
+        case Command::PushDeviceRemoved:
+        case Command::PushDeviceAdded:
+        case Command::ListDevicesReply:
+        case Command::ResponseReceived:
+        case Command::GrblPushReceived:
+        case Command::DeviceIsSupported:
+        case Command::EnableFlowControl:
+        case Command::DataReceived:
+        case Command::InitGrbl:
+        case Command::USBDeviceRemoved:
+        case Command::USBDeviceAdded:
+        case Command::Shutdown:
+        default: {
+        }
+    }
+
+    if (false == valid) {
+        log::warning(
+            "Dropping client command ",
+            static_cast<unsigned>(type),
+            " with ",
+            args,
+            " arguments");
+    }
+
+    return valid;
+}
+
+// NOTE runs before the actor starts so the ports are connected before any
+// request can reach them. The empty third argument means the machine uses its
+// own serial endpoint.
+auto Context::add_serial_ports() noexcept -> void
+{
+    const auto* ports = options_.serial_ports_;
+
+    if (nullptr == ports) { return; }
+
+    for (auto i = std::size_t{0}; i < options_.serial_port_count_; ++i) {
+        const auto& [id, path, baud] = ports[i];
+        const auto valid = (nullptr != id) && (0 < std::strlen(id)) &&
+                           (nullptr != path) && (0 < std::strlen(path));
+
+        if (false == valid) {
+            log::warning("Ignoring serial port ", i, " without ID or path");
+
+            continue;
+        }
+
+        auto command = zeromq_.Command(Command::USBDeviceAdded);
+        command.emplace_back(id, std::strlen(id));
+        command.emplace_back(path, std::strlen(path));
+        command.emplace_back();
+        command.emplace_back(baud);
+        command_usb_device_added(std::move(command));
+    }
+}
+
+// The analyzer needs the motion limits of the machine, which are attached by
+// the machine itself, or the defaults when no machine is specified
+auto Context::command_analyze_program(zmq::Message&& in) noexcept -> void
+{
+    if (3 > in.arg_count()) { abort(); }
+
+    if (3 < in.arg_count()) {
+        analysis_socket_.send(std::move(in));
+
+        return;
+    }
+
+    const auto address = in.arg(0).str();
+
+    if (0 < address.size()) {
+        if (const auto handle = devices_.find(address);
+            Devices::Invalid != handle) {
+            if (const auto& connection = devices_.get(handle).connection_;
+                connection) {
+                connection->first.send(std::move(in));
+
+                return;
+            }
+        }
+
+        log::warning("Unknown device: ", address);
+    }
+
+    in.emplace_back(gcode::Limits{});
+    analysis_socket_.send(std::move(in));
+}
+
 auto Context::command_list_devices(zmq::Message&& in) noexcept -> void
 {
     device_subscribers_.emplace(in.identity());
@@ -84,24 +372,47 @@ auto Context::command_list_devices(zmq::Message&& in) noexcept -> void
     reply.emplace_back();
     reply.emplace_back(Command::ListDevicesReply);
 
-    for (const auto& device : recognized_devices_) {
-        const auto& [key, value] = *device;
-        value.second.Describe(reply);
+    for (auto i = Devices::Handle{0}; i < devices_.size(); ++i) {
+        const auto& [connection, subscribers, recognized] = devices_.get(i);
+
+        if (recognized && connection) { connection->second.Describe(reply); }
     }
 
-    router_.send(std::move(reply));
+    deliver(std::move(reply));
 }
 
 auto Context::command_subscribe(zmq::Message&& in) noexcept -> void
 {
     for (auto i = std::size_t{0}; i < in.arg_count(); ++i) {
-        const auto address = std::string{in.arg(i).str()};
+        const auto address = in.arg(i).str();
 
         if (0u == i) {
-            machine_subscribers_[address].emplace(in.identity());
+            devices_.get(devices_.intern(address))
+                .subscribers_.insert_or_assign(
+                    in.identity(), std::uint32_t{LS_EVENT_ALL});
+        } else if (const auto handle = devices_.find(address);
+                   Devices::Invalid != handle) {
+            devices_.get(handle).subscribers_.erase(in.identity());
+        }
+    }
+}
+
+auto Context::command_subscribe_events(zmq::Message&& in) noexcept -> void
+{
+    if (2 > in.arg_count()) { return; }
+
+    try {
+        const auto mask = in.arg(1).as<std::uint32_t>() & LS_EVENT_ALL;
+        auto& subscribers =
+            devices_.get(devices_.intern(in.arg(0).str())).subscribers_;
+
+        if (0 == mask) {
+            subscribers.erase(in.identity());
         } else {
-            machine_subscribers_[address].erase(in.identity());
+            subscribers.insert_or_assign(in.identity(), mask);
         }
+    } catch (...) {
+        log::warning("Invalid event subscription");
     }
 }
 
@@ -109,52 +420,32 @@ auto Context::command_support_device(const std::string_view id) noexcept -> void
 {
     if ((nullptr == id.data()) || (0 == id.size())) { abort(); }
 
-    auto endpoint = std::string{};
-    auto it = find_or_create(id, endpoint, Operation::MustExist);
-    const auto sort = [this](const auto& lhs, const auto& rhs) -> auto
-    {
-        return std::distance(devices_.begin(), lhs) <
-               std::distance(devices_.begin(), rhs);
-    };
-
-    auto& vector = recognized_devices_;
-    vector.emplace_back(it);
-    std::sort(vector.begin(), vector.end(), sort);
-    vector.erase(std::unique(vector.begin(), vector.end()), vector.end());
+    find_or_create(id, {}, Operation::MustExist).recognized_ = true;
 }
 
 auto Context::command_support_device(zmq::Message&& in) noexcept -> void
 {
     if (1 > in.arg_count()) { abort(); }
 
-    const auto& address = in.arg(0);
-    const auto addressV = address.str();
-    auto endpoint = std::string{};
-    auto it = find_or_create(addressV, endpoint, Operation::MustExist);
-    const auto sort = [this](const auto& lhs, const auto& rhs) -> auto
-    {
-        return std::distance(devices_.begin(), lhs) <
-               std::distance(devices_.begin(), rhs);
-    };
-
-    auto& vector = recognized_devices_;
-    vector.emplace_back(it);
-    std::sort(vector.begin(), vector.end(), sort);
-    vector.erase(std::unique(vector.begin(), vector.end()), vector.end());
-    auto& [socket, device] = it->second;
+    auto& entry = find_or_create(in.arg(0).str(), {}, Operation::MustExist);
+    entry.recognized_ = true;
+    const auto& device = entry.connection_->second;
 
     for (const auto& id : device_subscribers_) {
         auto push = zmq::Message::MakePush(id, Command::PushDeviceAdded);
         device.Describe(push);
-        router_.send(std::move(push));
+        deliver(std::move(push));
     }
 }
 
 auto Context::command_unsubscribe(zmq::Message&& in) noexcept -> void
 {
     for (auto i = std::size_t{0}; i < in.arg_count(); ++i) {
-        const auto machineID = std::string{in.arg(i).str()};
-        machine_subscribers_[machineID].erase(in.identity());
+        const auto handle = devices_.find(in.arg(i).str());
+
+        if (Devices::Invalid == handle) { continue; }
+
+        devices_.get(handle).subscribers_.erase(in.identity());
     }
 }
 
@@ -169,7 +460,7 @@ auto Context::command_usb_device_added(zmq::Message&& in) noexcept -> void
     if (2 < in.arg_count()) { endpoint = in.arg(2).str(); }
 
     auto& [socket, device] =
-        find_or_create(addressV, endpoint, Operation::Add)->second;
+        *find_or_create(addressV, endpoint, Operation::Add).connection_;
     socket.send(std::move(in));
 }
 
@@ -186,11 +477,11 @@ auto Context::command_usb_device_removed(zmq::Message&& in) noexcept -> void
     for (const auto& id : device_subscribers_) {
         auto push = zmq::Message::MakePush(id, Command::PushDeviceRemoved);
         push.emplace_back(address);
-        router_.send(std::move(push));
+        deliver(std::move(push));
     }
 
     auto& [socket, device] =
-        find_or_create(addressV, endpoint, Operation::Remove)->second;
+        *find_or_create(addressV, endpoint, Operation::Remove).connection_;
     socket.send(std::move(in));
 }
 
@@ -198,54 +489,95 @@ auto Context::forward_to_machine(zmq::Message&& in) noexcept -> void
 {
     if (1 > in.arg_count()) { abort(); }
 
-    const auto address = std::string{in.arg(0).str()};
-    machine_subscribers_[address].emplace(in.identity());
+    const auto address = in.arg(0).str();
+    auto& [connection, subscribers, recognized] =
+        devices_.get(devices_.intern(address));
 
-    try {
-        const auto& [socket, machine] = devices_.at(address);
-        socket.send(std::move(in));
-    } catch (...) {
-        std::cout << "Unknown device: " << address << '\n';
+    // NOTE keeps the events selected by an earlier subscription
+    if (const auto identity = in.at(0).str();
+        subscribers.end() == subscribers.find(identity)) {
+        subscribers.emplace(in.identity(), std::uint32_t{LS_EVENT_ALL});
+    }
+
+    if (connection) {
+        connection->first.send(std::move(in));
+    } else {
+        log::warning("Unknown device: ", address);
     }
 }
 
 auto Context::forward_to_subscriber(
-    const std::string& machineID,
+    const std::string_view machineID,
     zmq::Message&& in) noexcept -> void
 {
-    try {
-        const auto& subscribers = machine_subscribers_.at(machineID);
+    const auto handle = devices_.find(machineID);
 
-        for (const auto& id : subscribers) {
-            auto push = zmq::Message::MakePush(id, in.type());
-            const auto stop{in.arg_count()};
+    if (Devices::Invalid == handle) { return; }
 
-            for (auto i = std::size_t{0}; i < stop; ++i) {
-                push.emplace_back(in.arg(i));
-            }
+    const auto& subscribers = devices_.get(handle).subscribers_;
+    const auto type = event(in);
+    const auto conflate =
+        (LS_EVENT_STATUS == type) || (LS_EVENT_PROGRESS == type);
 
-            router_.send(std::move(push));
-        }
-    } catch (...) {
+    // NOTE every recipient shares the payloads of in, so the cost of each one
+    // does not depend on the size of the message
+    for (const auto& [id, mask] : subscribers) {
+        if (0 == (mask & type)) { continue; }
+
+        deliver(in.forward(id), conflate);
+    }
+}
+
+auto Context::IdentityLess::operator()(
+    const SubscriberID& lhs,
+    const SubscriberID& rhs) const noexcept -> bool
+{
+    return lhs < rhs;
+}
+
+auto Context::IdentityLess::operator()(
+    const SubscriberID& lhs,
+    const std::string_view rhs) const noexcept -> bool
+{
+    return view(lhs) < rhs;
+}
+
+auto Context::IdentityLess::operator()(
+    const std::string_view lhs,
+    const SubscriberID& rhs) const noexcept -> bool
+{
+    return lhs < view(rhs);
+}
+
+auto Context::deliver(zmq::Message&& message, const bool conflate) noexcept
+    -> void
+{
+    auto it = outboxes_.find(message.at(0).str());
+
+    if (outboxes_.end() == it) {
+        const auto id = message.identity();
+        const auto send = [this](zmq::Message& out) -> int {
+            return router_.send_nonblocking(out);
+        };
+        it = outboxes_
+                 .try_emplace(
+                     id, id, send, options_.subscriber_queue_limit_)
+                 .first;
     }
+
+    handle(it->first, it->second.send(std::move(message), conflate));
 }
 
 auto Context::find_or_create(
     const std::string_view address,
     const std::string_view port,
-    const Operation op) noexcept -> DeviceMap::iterator
-{
-    auto output = devices_.find(std::string{address});
-
-    if (devices_.end() != output) {
-        if (Operation::Remove == op) {
-            recognized_devices_.erase(
-                std::remove(
-                    recognized_devices_.begin(),
-                    recognized_devices_.end(),
-                    output),
-                recognized_devices_.end());
-        }
+    const Operation op) noexcept -> Device&
+{
+    const auto handle = devices_.intern(address);
+    auto& output = devices_.get(handle);
+
+    if (output.connection_) {
+        if (Operation::Remove == op) { output.recognized_ = false; }
 
         return output;
     } else if (Operation::MustExist == op) {
@@ -254,23 +586,19 @@ auto Context::find_or_create(
 
     const auto useProvided = (nullptr != port.data()) && (0 < port.size());
     const auto internal = RandomEndpoint();
-    auto [it, added] = devices_.emplace(
+    output.connection_ = std::make_unique<Connection>(
         std::piecewise_construct,
-        std::forward_as_tuple(address),
         std::forward_as_tuple(
-            std::piecewise_construct,
-            std::forward_as_tuple(
-                zeromq_.Socket(ZMQ_PAIR, Direction::Bind, internal)),
-            std::forward_as_tuple(
-                zeromq_,
-                address,
-                internal,
-                !useProvided,
-                useProvided ? std::string{port} : RandomEndpoint())));
-
-    assert(added);
-
-    auto& [socket, device] = it->second;
+            zeromq_.Socket(ZMQ_PAIR, Direction::Bind, internal)),
+        std::forward_as_tuple(
+            zeromq_,
+            reactor_.get(),
+            options_,
+            devices_.id(handle),
+            internal,
+            !useProvided,
+            useProvided ? std::string{port} : RandomEndpoint()));
+    auto& [socket, device] = *output.connection_;
 
     assert(nullptr != socket);
 
@@ -278,7 +606,23 @@ auto Context::find_or_create(
     poll.socket = socket;
     poll.events = ZMQ_POLLIN;
 
-    return it;
+    return output;
+}
+
+auto Context::handle(const SubscriberID& id, const Outbox::State state) noexcept
+    -> void
+{
+    switch (state) {
+        case Outbox::State::Waiting: {
+            set_timer(std::min(timer(), Clock::now() + OutboxRetryInterval));
+        } break;
+        case Outbox::State::Unreachable: {
+            unreachable_.emplace_back(id);
+        } break;
+        case Outbox::State::Empty:
+        default: {
+        }
+    }
 }
 
 auto Context::process_command(zmq::Message&& command) noexcept -> bool
@@ -298,6 +642,9 @@ auto Context::process_command(zmq::Message&& command) noexcept -> bool
         case Command::Unsubscribe: {
             command_unsubscribe(std::move(command));
         } break;
+        case Command::SubscribeEvents: {
+            command_subscribe_events(std::move(command));
+        } break;
         case Command::USBDeviceAdded: {
             command_usb_device_added(std::move(command));
         } break;
@@ -307,6 +654,12 @@ auto Context::process_command(zmq::Message&& command) noexcept -> bool
         case Command::DeviceIsSupported: {
             command_support_device(std::move(command));
         } break;
+        case Command::AnalyzeProgram: {
+            command_analyze_program(std::move(command));
+        } break;
+        case Command::ProgramAnalysis: {
+            deliver(std::move(command));
+        } break;
         case Command::GrblHelp:
         case Command::GrblStatus:
         case Command::GrblSettings:
@@ -321,18 +674,21 @@ auto Context::process_command(zmq::Message&& command) noexcept -> bool
         case Command::GrblCycleToggle:
         case Command::GrblFeedHold:
         case Command::GrblJogCancel:
-        case Command::SendGcode: {
+        case Command::SendGcode:
+        case Command::ExecuteProgram:
+        case Command::ResumeProgram: {
             forward_to_machine(std::move(command));
         } break;
         case Command::GrblPushReceived:
+        case Command::StatusReport:
+        case Command::ProgramProgress:
         case Command::ResponseReceived: {
             assert(1 <= command.arg_count());
 
-            forward_to_subscriber(
-                std::string{command.arg(0).str()}, std::move(command));
+            forward_to_subscriber(command.arg(0).str(), std::move(command));
         } break;
         case Command::Invalid:
-        case Command::ExecuteProgram:
+        case Command::EventsDropped:
         case Command::PushDeviceRemoved:
         case Command::PushDeviceAdded:
         case Command::ListDevicesReply:
@@ -340,15 +696,47 @@ auto Context::process_command(zmq::Message&& command) noexcept -> bool
         case Command::DataReceived:
         case Command::InitGrbl:
         default: {
-            std::cout << "Unsupported command: "
-                      << std::to_string(
-                             static_cast<std::uint8_t>(command.type()))
-                      << '\n';
+            log::warning(
+                "Unsupported command: ",
+                static_cast<std::uint8_t>(command.type()));
         }
     }
 
+    remove_unreachable();
+
     return disconnectAfter;
 }
 
-Context::~Context() { shutdown_actor(); }
+auto Context::process_timer() noexcept -> void
+{
+    for (auto& [id, outbox] : outboxes_) {
+        if (0 < outbox.size()) { handle(id, outbox.flush()); }
+    }
+
+    remove_unreachable();
+}
+
+// NOTE subscribers are removed after the loops which send to them, since
+// removing them invalidates iterators into the subscriber lists
+auto Context::remove_unreachable() noexcept -> void
+{
+    for (const auto& id : unreachable_) {
+        log::debug("Removing unreachable subscriber");
+        device_subscribers_.erase(id);
+
+        for (auto i = Devices::Handle{0}; i < devices_.size(); ++i) {
+            devices_.get(i).subscribers_.erase(id);
+        }
+
+        outboxes_.erase(id);
+    }
+
+    unreachable_.clear();
+}
+
+Context::~Context()
+{
+    shutdown_actor();
+    log::flush();
+}
 }  // namespace libsubtractive
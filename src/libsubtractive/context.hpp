@@ -7,19 +7,21 @@
 #include <cstdint>
 #include <functional>
 #include <map>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
 #include "libsubtractive/actor.hpp"
+#include "libsubtractive/analysis.hpp"
 #include "libsubtractive/communication/usb/hotplug.hpp"
 #include "libsubtractive/communication/zmq/zeromq_wrapper.hpp"
 #include "libsubtractive/machine.hpp"  // IWYU pragma: keep
-
-extern "C" {
-struct LS_options;
-}
+#include "libsubtractive/libsubtractive.hpp"
+#include "libsubtractive/outbox.hpp"
+#include "libsubtractive/reactor.hpp"
+#include "libsubtractive/registry.hpp"
 
 namespace libsubtractive
 {
@@ -41,39 +43,83 @@ public:
 private:
     friend Actor<Context>;
 
-    using DeviceID = std::string;
-    using DeviceMap = std::map<DeviceID, std::pair<zmq::Socket, Machine>>;
     using SubscriberID = std::vector<std::byte>;
+
+    // Also compares subscriber IDs with the identity frame of a message, so
+    // subscribers are found without copying the frame
+    struct IdentityLess {
+        using is_transparent = void;
+
+        auto operator()(const SubscriberID& lhs, const SubscriberID& rhs)
+            const noexcept -> bool;
+        auto operator()(const SubscriberID& lhs, const std::string_view rhs)
+            const noexcept -> bool;
+        auto operator()(const std::string_view lhs, const SubscriberID& rhs)
+            const noexcept -> bool;
+    };
+
     using DeviceSubscribers = boost::container::flat_set<SubscriberID>;
-    using MachineSubscribers = boost::container::
-        flat_map<DeviceID, boost::container::flat_set<SubscriberID>>;
+    // LS_Event bits selected by each subscriber
+    using Subscribers =
+        boost::container::flat_map<SubscriberID, std::uint32_t, IdentityLess>;
+    using Connection = std::pair<zmq::Socket, Machine>;
+
+    struct Device {
+        // Null until the device is connected, since clients may subscribe to
+        // machines which have not been seen yet
+        std::unique_ptr<Connection> connection_{};
+        Subscribers subscribers_{};
+        // Listed in LS_LISTDEVICES replies
+        bool recognized_{false};
+    };
+
+    using Devices = Registry<Device>;
 
     enum class Operation : std::int8_t { Remove = -1, Add = 0, MustExist = 1 };
 
+    const LS_options options_;
     const zmq::Socket& router_;
+    const zmq::Socket& analysis_socket_;
     Hotplug hotplug_;
-    DeviceMap devices_;
+    Analysis analysis_;
+    std::unique_ptr<Reactor> reactor_;
+    Devices devices_;
     DeviceSubscribers device_subscribers_;
-    MachineSubscribers machine_subscribers_;
-    std::vector<DeviceMap::iterator> recognized_devices_;
+    std::map<SubscriberID, Outbox, IdentityLess> outboxes_;
+    std::vector<SubscriberID> unreachable_;
 
+    auto accept_command(const void* socket, const zmq::Message& in)
+        const noexcept -> bool;
+    auto add_serial_ports() noexcept -> void;
+    auto command_analyze_program(zmq::Message&& in) noexcept -> void;
     auto command_list_devices(zmq::Message&& in) noexcept -> void;
     auto command_subscribe(zmq::Message&& in) noexcept -> void;
+    auto command_subscribe_events(zmq::Message&& in) noexcept -> void;
     auto command_support_device(zmq::Message&& in) noexcept -> void;
     auto command_support_device(const std::string_view id) noexcept -> void;
     auto command_unsubscribe(zmq::Message&& in) noexcept -> void;
     auto command_usb_device_added(zmq::Message&& in) noexcept -> void;
     auto command_usb_device_removed(zmq::Message&& in) noexcept -> void;
+    auto deliver(zmq::Message&& message, const bool conflate = false) noexcept
+        -> void;
     auto forward_to_machine(zmq::Message&& in) noexcept -> void;
     auto forward_to_subscriber(
-        const std::string& machineID,
+        const std::string_view machineID,
         zmq::Message&& in) noexcept -> void;
     auto find_or_create(
         const std::string_view serialNum,
         const std::string_view endpoint,
-        const Operation op) noexcept -> DeviceMap::iterator;
+        const Operation op) noexcept -> Device&;
+    auto handle(const SubscriberID& id, const Outbox::State state) noexcept
+        -> void;
     auto process_command(zmq::Message&& command) noexcept -> bool;
+    auto process_timer() noexcept -> void;
+    auto remove_unreachable() noexcept -> void;
 
+    Context(
+        const LS_options& options,
+        const std::string& analysisEndpoint,
+        const std::string& hotplugEndpoint);
     Context() = delete;
 };
 }  // namespace libsubtractive
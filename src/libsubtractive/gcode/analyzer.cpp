@@ -0,0 +1,710 @@
+#include "libsubtractive/gcode/analyzer.hpp"  // IWYU pragma: associated
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "libsubtractive/gcode/lexer.hpp"
+
+namespace libsubtractive::gcode
+{
+namespace
+{
+// Bytes lexed by each thread per round
+constexpr auto ChunkSize = std::size_t{8u * 1024u * 1024u};
+constexpr auto MillimetresPerInch = 25.4;
+constexpr auto Pi = 3.14159265358979323846;
+// Same tolerance Grbl uses to recognize a full circle
+constexpr auto FullCircle = 5e-7;
+constexpr auto MaxCodes = std::size_t{8};
+// Letters of the words which affect motion, in the order of Block::values_
+constexpr auto Letters = std::string_view{"XYZIJKRFP"};
+
+enum Letter : std::size_t { X, Y, Z, I, J, K, R, F, P };
+
+using Vector = std::array<double, 3>;
+
+// A lexed line reduced to the words which affect motion
+struct Block {
+    std::array<double, Letters.size()> values_{};
+    // G codes keyed by ten times their value so G38.2 is 382
+    std::array<std::int16_t, MaxCodes> codes_{};
+    std::uint16_t words_{};
+    std::uint8_t count_{};
+    // M0, M1, M2 or M30
+    bool stop_{};
+    // M2 or M30
+    bool end_{};
+
+    auto has(const std::size_t letter) const noexcept -> bool
+    {
+        return 0u != (words_ & (1u << letter));
+    }
+};
+
+struct Chunk {
+    std::string_view text_{};
+    std::vector<Block> blocks_{};
+    std::uint64_t lines_{};
+    std::uint64_t skipped_{};
+};
+
+struct Move {
+    double length_{};
+    // Nominal speed (mm/s) and acceleration (mm/s^2) along the path
+    double speed_{};
+    double acceleration_{};
+    // Direction of travel at the start and at the end of the move
+    Vector entry_{};
+    Vector exit_{};
+};
+
+// Interprets blocks in program order and accumulates the statistics
+class Interpreter
+{
+public:
+    auto finish(LS_program_analysis& out) noexcept -> void;
+    auto operator()(const Block& block) noexcept -> void;
+
+    Interpreter(const Limits& limits) noexcept;
+
+private:
+    const Limits& limits_;
+    Vector position_;
+    int motion_;
+    int plane_;
+    bool absolute_;
+    bool inch_;
+    bool inverse_;
+    double feed_;
+    std::optional<Move> pending_;
+    double entry_;
+    LS_program_analysis stats_;
+    bool bounded_;
+    double feed_weighted_;
+
+    auto arc(const Block& block, const Vector& target, const bool clockwise)
+        noexcept -> void;
+    auto bound(const Vector& point) noexcept -> void;
+    auto feed_speed(const double length) const noexcept -> double;
+    auto line(const Vector& target, const bool rapid) noexcept -> void;
+    auto plan(const Move& move) noexcept -> void;
+    auto record_feed(const double speed, const double length) noexcept
+        -> void;
+    auto stop() noexcept -> void;
+};
+
+auto code(const double value) noexcept -> int;
+auto code(const double value) noexcept -> int
+{
+    return static_cast<int>(std::lround(value * 10.0));
+}
+
+auto encode(const std::vector<Word>& words, Block& out) noexcept -> void;
+auto encode(const std::vector<Word>& words, Block& out) noexcept -> void
+{
+    for (const auto& word : words) {
+        switch (word.letter_) {
+            case 'G': {
+                if (MaxCodes > out.count_) {
+                    out.codes_.at(out.count_++) =
+                        static_cast<std::int16_t>(code(word.value_));
+                }
+            } break;
+            case 'M': {
+                const auto value = code(word.value_);
+                const auto end = (20 == value) || (300 == value);
+                out.stop_ |= end || (0 == value) || (10 == value);
+                out.end_ |= end;
+            } break;
+            default: {
+                const auto index = Letters.find(word.letter_);
+
+                if (std::string_view::npos == index) { continue; }
+
+                out.values_.at(index) = word.value_;
+                out.words_ |= static_cast<std::uint16_t>(1u << index);
+            }
+        }
+    }
+}
+
+auto lex(Chunk& chunk) noexcept -> void;
+auto lex(Chunk& chunk) noexcept -> void
+{
+    auto lexer = Lexer{};
+    auto text = chunk.text_;
+    chunk.blocks_.clear();
+    chunk.lines_ = 0;
+    chunk.skipped_ = 0;
+
+    while (0 < text.size()) {
+        const auto newline = text.find('\n');
+        const auto line = text.substr(0, newline);
+        text.remove_prefix(
+            (std::string_view::npos == newline) ? text.size() : newline + 1u);
+        ++chunk.lines_;
+
+        switch (lexer(line)) {
+            case Lexer::Type::Block: {
+                auto block = Block{};
+                encode(lexer.words(), block);
+
+                if ((0u == block.words_) && (0u == block.count_) &&
+                    (false == block.stop_)) {
+                    continue;
+                }
+
+                chunk.blocks_.emplace_back(block);
+            } break;
+            case Lexer::Type::Other: {
+                ++chunk.skipped_;
+            } break;
+            case Lexer::Type::Empty:
+            default: {
+            }
+        }
+    }
+}
+
+// Returns the lowest of the per axis values scaled to a direction of travel
+auto limit(const Vector& direction, const Vector& values) noexcept -> double;
+auto limit(const Vector& direction, const Vector& values) noexcept -> double
+{
+    auto output = std::numeric_limits<double>::infinity();
+
+    for (auto i = std::size_t{0}; i < direction.size(); ++i) {
+        const auto component = std::abs(direction.at(i));
+
+        if (1e-9 < component) {
+            output = std::min(output, values.at(i) / component);
+        }
+    }
+
+    return output;
+}
+
+// Duration of a move which starts at speed entry, accelerates towards its
+// nominal speed and decelerates to speed exit
+auto travel(const Move& move, const double entry, const double exit) noexcept
+    -> double;
+auto travel(const Move& move, const double entry, const double exit) noexcept
+    -> double
+{
+    const auto a = move.acceleration_;
+    const auto top = move.speed_;
+
+    if ((false == (0.0 < a)) || (false == (0.0 < top))) { return 0.0; }
+
+    const auto peak =
+        ((2.0 * a * move.length_) + (entry * entry) + (exit * exit)) / 2.0;
+
+    // NOTE triangular profile when the nominal speed is never reached
+    if (peak <= (top * top)) {
+        const auto speed = std::sqrt(peak);
+
+        return ((speed - entry) + (speed - exit)) / a;
+    }
+
+    const auto accelerate = ((top * top) - (entry * entry)) / (2.0 * a);
+    const auto decelerate = ((top * top) - (exit * exit)) / (2.0 * a);
+    const auto cruise = move.length_ - accelerate - decelerate;
+
+    return ((top - entry) / a) + ((top - exit) / a) + (cruise / top);
+}
+
+Interpreter::Interpreter(const Limits& limits) noexcept
+    : limits_(limits)
+    , position_()
+    , motion_(0)
+    , plane_(170)
+    , absolute_(true)
+    , inch_(false)
+    , inverse_(false)
+    , feed_(0.0)
+    , pending_(std::nullopt)
+    , entry_(0.0)
+    , stats_()
+    , bounded_(false)
+    , feed_weighted_(0.0)
+{
+}
+
+auto Interpreter::arc(
+    const Block& block,
+    const Vector& target,
+    const bool clockwise) noexcept -> void
+{
+    // Indices of the first and second axis of the plane and the linear axis
+    const auto [a0, a1, l] = [&]() -> std::array<std::size_t, 3> {
+        switch (plane_) {
+            case 180: {
+                return {Z, X, Y};
+            }
+            case 190: {
+                return {Y, Z, X};
+            }
+            default: {
+                return {X, Y, Z};
+            }
+        }
+    }();
+    const auto scale = inch_ ? MillimetresPerInch : 1.0;
+    const auto& start = position_;
+    const auto x = target.at(a0) - start.at(a0);
+    const auto y = target.at(a1) - start.at(a1);
+    auto cx = 0.0;
+    auto cy = 0.0;
+
+    if (block.has(R)) {
+        // NOTE same construction as Grbl, including the sign conventions
+        auto radius = block.values_.at(R) * scale;
+        auto h = (4.0 * radius * radius) - (x * x) - (y * y);
+
+        if ((0.0 > h) || ((0.0 == x) && (0.0 == y))) {
+            line(target, false);
+
+            return;
+        }
+
+        h = -std::sqrt(h) / std::hypot(x, y);
+
+        if (false == clockwise) { h = -h; }
+
+        if (0.0 > radius) {
+            h = -h;
+            radius = -radius;
+        }
+
+        cx = 0.5 * (x - (y * h));
+        cy = 0.5 * (y + (x * h));
+    } else {
+        cx = block.values_.at(I + a0) * scale;
+        cy = block.values_.at(I + a1) * scale;
+    }
+
+    const auto radius = std::hypot(cx, cy);
+
+    if (0.0 == radius) {
+        line(target, false);
+
+        return;
+    }
+
+    const auto centre0 = start.at(a0) + cx;
+    const auto centre1 = start.at(a1) + cy;
+    const auto begin = std::atan2(-cy, -cx);
+    const auto end =
+        std::atan2(target.at(a1) - centre1, target.at(a0) - centre0);
+    auto sweep = end - begin;
+
+    if (clockwise) {
+        if (sweep >= -FullCircle) { sweep -= 2.0 * Pi; }
+    } else {
+        if (sweep <= FullCircle) { sweep += 2.0 * Pi; }
+    }
+
+    const auto planar = radius * std::abs(sweep);
+    const auto linear = target.at(l) - start.at(l);
+    const auto length = std::hypot(planar, linear);
+    const auto tangent = [&](const double angle) {
+        const auto direction = clockwise ? -1.0 : 1.0;
+        auto output = Vector{};
+        output.at(a0) = -std::sin(angle) * direction * planar / length;
+        output.at(a1) = std::cos(angle) * direction * planar / length;
+        output.at(l) = linear / length;
+
+        return output;
+    };
+
+    ++stats_.moves_;
+    ++stats_.arcs_;
+    bound(start);
+    bound(target);
+
+    // NOTE the extremes of the arc are where it crosses the plane axes
+    for (auto quarter = 0; quarter < 4; ++quarter) {
+        const auto angle = quarter * Pi / 2.0;
+        auto offset =
+            std::fmod(clockwise ? (begin - angle) : (angle - begin), 2.0 * Pi);
+
+        if (0.0 > offset) { offset += 2.0 * Pi; }
+
+        if (offset > std::abs(sweep)) { continue; }
+
+        auto point = start;
+        point.at(a0) = centre0 + (radius * std::cos(angle));
+        point.at(a1) = centre1 + (radius * std::sin(angle));
+        point.at(l) += linear * offset / std::abs(sweep);
+        bound(point);
+    }
+
+    auto move = Move{};
+    move.length_ = length;
+    move.entry_ = tangent(begin);
+    move.exit_ = tangent(begin + sweep);
+    auto rate = std::min(limits_.rate_.at(a0), limits_.rate_.at(a1));
+    auto acceleration =
+        std::min(limits_.acceleration_.at(a0), limits_.acceleration_.at(a1));
+
+    if (0.0 != linear) {
+        const auto fraction = std::abs(linear) / length;
+        rate = std::min(rate, limits_.rate_.at(l) / fraction);
+        acceleration =
+            std::min(acceleration, limits_.acceleration_.at(l) / fraction);
+    }
+
+    move.speed_ = std::min(rate / 60.0, feed_speed(length));
+    move.acceleration_ = acceleration;
+    stats_.feed_distance_ += length;
+    record_feed(move.speed_, length);
+    position_ = target;
+    plan(move);
+}
+
+auto Interpreter::bound(const Vector& point) noexcept -> void
+{
+    for (auto i = std::size_t{0}; i < point.size(); ++i) {
+        auto& low = stats_.min_[i];
+        auto& high = stats_.max_[i];
+        low = bounded_ ? std::min(low, point.at(i)) : point.at(i);
+        high = bounded_ ? std::max(high, point.at(i)) : point.at(i);
+    }
+
+    bounded_ = true;
+}
+
+auto Interpreter::feed_speed(const double length) const noexcept -> double
+{
+    // NOTE Grbl rejects feed moves without a feed rate, in which case the
+    // axis limits are the best available estimate
+    if (false == (0.0 < feed_)) {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    // NOTE in inverse time mode F is the reciprocal of the duration in minutes
+    if (inverse_) { return length * feed_ / 60.0; }
+
+    return feed_ * (inch_ ? MillimetresPerInch : 1.0) / 60.0;
+}
+
+auto Interpreter::finish(LS_program_analysis& out) noexcept -> void
+{
+    stop();
+    out.moves_ = stats_.moves_;
+    out.arcs_ = stats_.arcs_;
+    out.duration_ = stats_.duration_;
+    out.rapid_distance_ = stats_.rapid_distance_;
+    out.feed_distance_ = stats_.feed_distance_;
+    std::copy(std::begin(stats_.min_), std::end(stats_.min_), out.min_);
+    std::copy(std::begin(stats_.max_), std::end(stats_.max_), out.max_);
+    out.feed_min_ = stats_.feed_min_;
+    out.feed_max_ = stats_.feed_max_;
+    out.feed_mean_ = (0.0 < stats_.feed_distance_)
+                         ? (feed_weighted_ / stats_.feed_distance_)
+                         : 0.0;
+}
+
+auto Interpreter::line(const Vector& target, const bool rapid) noexcept -> void
+{
+    auto direction = Vector{};
+    auto length = 0.0;
+
+    for (auto i = std::size_t{0}; i < target.size(); ++i) {
+        direction.at(i) = target.at(i) - position_.at(i);
+        length += direction.at(i) * direction.at(i);
+    }
+
+    length = std::sqrt(length);
+
+    if (0.0 == length) { return; }
+
+    for (auto& component : direction) { component /= length; }
+
+    ++stats_.moves_;
+    bound(position_);
+    bound(target);
+    auto move = Move{};
+    move.length_ = length;
+    move.entry_ = direction;
+    move.exit_ = direction;
+    move.acceleration_ = limit(direction, limits_.acceleration_);
+    const auto rate = limit(direction, limits_.rate_) / 60.0;
+
+    if (rapid) {
+        move.speed_ = rate;
+        stats_.rapid_distance_ += length;
+    } else {
+        move.speed_ = std::min(rate, feed_speed(length));
+        stats_.feed_distance_ += length;
+        record_feed(move.speed_, length);
+    }
+
+    position_ = target;
+    plan(move);
+}
+
+auto Interpreter::operator()(const Block& block) noexcept -> void
+{
+    auto dwell{false};
+    auto nonmodal = 0;
+
+    for (auto i = std::size_t{0}; i < block.count_; ++i) {
+        switch (const auto value = block.codes_.at(i); value) {
+            case 0:
+            case 10:
+            case 20:
+            case 30:
+            case 382:
+            case 383:
+            case 384:
+            case 385:
+            case 800: {
+                motion_ = value;
+            } break;
+            case 170:
+            case 180:
+            case 190: {
+                plane_ = value;
+            } break;
+            case 200:
+            case 210: {
+                inch_ = (200 == value);
+            } break;
+            case 900:
+            case 910: {
+                absolute_ = (900 == value);
+            } break;
+            case 930:
+            case 940: {
+                inverse_ = (930 == value);
+            } break;
+            case 40: {
+                dwell = true;
+            } break;
+            case 100:
+            case 280:
+            case 281:
+            case 300:
+            case 301:
+            case 530:
+            case 920:
+            case 921:
+            case 922:
+            case 923: {
+                nonmodal = value;
+            } break;
+            default: {
+            }
+        }
+    }
+
+    if (block.has(F)) { feed_ = block.values_.at(F); }
+
+    if (dwell) {
+        stop();
+
+        if (block.has(P)) {
+            stats_.duration_ += std::max(0.0, block.values_.at(P));
+        }
+    }
+
+    const auto scale = inch_ ? MillimetresPerInch : 1.0;
+    auto target = position_;
+    auto axes{false};
+
+    for (auto i = std::size_t{X}; i <= Z; ++i) {
+        if (false == block.has(i)) { continue; }
+
+        const auto value = block.values_.at(i) * scale;
+        // NOTE G53 and G92 coordinates are absolute regardless of G91
+        const auto absolute = absolute_ || (530 == nonmodal) ||
+                              (920 == nonmodal);
+        target.at(i) = absolute ? value : (position_.at(i) + value);
+        axes = true;
+    }
+
+    switch (nonmodal) {
+        case 920: {
+            // NOTE G92 changes the coordinate system, not the position
+            stop();
+            position_ = target;
+        } break;
+        case 280:
+        case 300: {
+            // NOTE the home positions are not part of the program so the
+            // position after G28 and G30 is unknown
+            stop();
+        } break;
+        case 100:
+        case 281:
+        case 301:
+        case 921:
+        case 922:
+        case 923: {
+        } break;
+        default: {
+            if (false == axes) { break; }
+
+            switch (motion_) {
+                case 0: {
+                    line(target, true);
+                } break;
+                case 20:
+                case 30: {
+                    arc(block, target, (20 == motion_));
+                } break;
+                case 800: {
+                } break;
+                default: {
+                    line(target, false);
+                }
+            }
+        }
+    }
+
+    if (block.stop_) { stop(); }
+
+    // NOTE Grbl restores these modes at the end of a program
+    if (block.end_) {
+        motion_ = 10;
+        plane_ = 170;
+        absolute_ = true;
+        inverse_ = false;
+    }
+}
+
+auto Interpreter::plan(const Move& move) noexcept -> void
+{
+    if (pending_.has_value()) {
+        const auto& previous = pending_.value();
+        auto cosine = 0.0;
+
+        for (auto i = std::size_t{0}; i < move.entry_.size(); ++i) {
+            cosine += previous.exit_.at(i) * move.entry_.at(i);
+        }
+
+        auto junction =
+            std::min(previous.speed_, move.speed_) * std::max(0.0, cosine);
+        // NOTE the following move must be able to stop before its end since
+        // the moves after it are not known yet
+        junction = std::min(
+            junction, std::sqrt(2.0 * move.acceleration_ * move.length_));
+        const auto reachable = std::sqrt(
+            (entry_ * entry_) +
+            (2.0 * previous.acceleration_ * previous.length_));
+        const auto exit = std::min(junction, reachable);
+        stats_.duration_ += travel(previous, entry_, exit);
+        entry_ = exit;
+    }
+
+    pending_ = move;
+}
+
+auto Interpreter::record_feed(const double speed, const double length) noexcept
+    -> void
+{
+    const auto feed = speed * 60.0;
+    // NOTE feed rates are always positive so a zero maximum means none yet
+    const auto first = (0.0 == stats_.feed_max_);
+    stats_.feed_min_ = first ? feed : std::min(stats_.feed_min_, feed);
+    stats_.feed_max_ = std::max(stats_.feed_max_, feed);
+    feed_weighted_ += feed * length;
+}
+
+auto Interpreter::stop() noexcept -> void
+{
+    if (pending_.has_value()) {
+        stats_.duration_ += travel(pending_.value(), entry_, 0.0);
+        pending_.reset();
+    }
+
+    entry_ = 0.0;
+}
+}  // namespace
+
+auto Limits::set(const unsigned setting, const double value) noexcept -> bool
+{
+    if (false == (0.0 < value)) { return false; }
+
+    if ((110u <= setting) && (112u >= setting)) {
+        rate_.at(setting - 110u) = value;
+
+        return true;
+    }
+
+    if ((120u <= setting) && (122u >= setting)) {
+        acceleration_.at(setting - 120u) = value;
+
+        return true;
+    }
+
+    return false;
+}
+
+Analyzer::Analyzer(const Limits& limits, const unsigned threads) noexcept
+    : limits_(limits)
+    , threads_(
+          (0u < threads) ? threads
+                         : std::max(1u, std::thread::hardware_concurrency()))
+{
+}
+
+auto Analyzer::operator()(const std::string_view program) const noexcept
+    -> LS_program_analysis
+{
+    auto output = LS_program_analysis{};
+    auto chunks = std::vector<Chunk>(threads_);
+    auto workers = std::vector<std::thread>{};
+    auto interpreter = Interpreter{limits_};
+    auto offset = std::size_t{0};
+    workers.reserve(threads_);
+
+    while (offset < program.size()) {
+        auto count = std::size_t{0};
+
+        for (; (count < chunks.size()) && (offset < program.size()); ++count) {
+            auto end = offset + ChunkSize;
+
+            if (end >= program.size()) {
+                end = program.size();
+            } else {
+                const auto newline = program.find('\n', end);
+                end = (std::string_view::npos == newline) ? program.size()
+                                                          : newline + 1u;
+            }
+
+            chunks.at(count).text_ = program.substr(offset, end - offset);
+            offset = end;
+        }
+
+        for (auto i = std::size_t{1}; i < count; ++i) {
+            workers.emplace_back([&chunk = chunks.at(i)] { lex(chunk); });
+        }
+
+        lex(chunks.at(0));
+
+        for (auto& worker : workers) { worker.join(); }
+
+        workers.clear();
+
+        for (auto i = std::size_t{0}; i < count; ++i) {
+            const auto& chunk = chunks.at(i);
+            output.lines_ += chunk.lines_;
+            output.skipped_ += chunk.skipped_;
+
+            for (const auto& block : chunk.blocks_) { interpreter(block); }
+        }
+    }
+
+    interpreter.finish(output);
+    output.state_ = LS_PROGRAM_COMPLETE;
+
+    return output;
+}
+}  // namespace libsubtractive::gcode
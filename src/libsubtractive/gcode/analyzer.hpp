@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <string_view>
+
+#include "libsubtractive/libsubtractive.hpp"
+
+namespace libsubtractive::gcode
+{
+// Maximum rate (mm/min) and acceleration (mm/s^2) of the X, Y and Z axes,
+// initialized to the Grbl defaults
+struct Limits {
+    std::array<double, 3> rate_{500.0, 500.0, 500.0};
+    std::array<double, 3> acceleration_{10.0, 10.0, 10.0};
+
+    // Applies one Grbl setting. Returns false for settings which are not
+    // limits ($110-$112 and $120-$122) and for values which are not positive.
+    auto set(const unsigned setting, const double value) noexcept -> bool;
+};
+
+// Computes the statistics reported by LS_ANALYZE_PROGRAM. The program is
+// split into chunks at line boundaries which are lexed in parallel, then the
+// lexed blocks are interpreted in order since every block depends on the
+// modal state and position left by the blocks before it. Chunks are processed
+// in rounds of one per thread so memory use does not depend on the program
+// size.
+//
+// The duration comes from a trapezoidal velocity profile for each move. The
+// speed through the junction between two moves is limited by the angle
+// between them and by the distance available to stop on the following move.
+class Analyzer
+{
+public:
+    auto operator()(const std::string_view program) const noexcept
+        -> LS_program_analysis;
+
+    // 0 threads uses one per hardware thread
+    Analyzer(const Limits& limits, const unsigned threads) noexcept;
+
+private:
+    const Limits limits_;
+    const unsigned threads_;
+};
+}  // namespace libsubtractive::gcode
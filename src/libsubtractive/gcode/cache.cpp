@@ -0,0 +1,479 @@
+#include "libsubtractive/gcode/cache.hpp"  // IWYU pragma: associated
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <tuple>
+#include <utility>
+
+namespace libsubtractive::gcode
+{
+namespace
+{
+constexpr auto Magic = std::array<char, 8>{'L', 'S', 'P', 'R', 'O', 'G', 0, 2};
+constexpr auto Extension = std::string_view{".lsp"};
+// Hexadecimal key followed by the extension
+constexpr auto NameSize = std::size_t{32} + Extension.size();
+constexpr auto FlushSize = std::size_t{1u << 20};
+constexpr auto Prime1 = std::uint64_t{0x9E3779B185EBCA87u};
+constexpr auto Prime2 = std::uint64_t{0xC2B2AE3D27D4EB4Fu};
+
+struct Header {
+    std::array<char, 8> magic_{};
+    Cache::Key key_{};
+    std::uint64_t source_size_{};
+    std::uint64_t source_lines_{};
+    std::uint64_t errors_{};
+    std::uint64_t count_{};
+    std::uint64_t text_offset_{};
+    std::uint64_t text_size_{};
+    std::uint64_t index_offset_{};
+    std::uint64_t checkpoint_offset_{};
+    std::uint64_t checkpoint_size_{};
+};
+
+auto finalize(std::uint64_t value) noexcept -> std::uint64_t;
+auto finalize(std::uint64_t value) noexcept -> std::uint64_t
+{
+    value ^= value >> 33u;
+    value *= std::uint64_t{0xFF51AFD7ED558CCDu};
+    value ^= value >> 33u;
+    value *= std::uint64_t{0xC4CEB9FE1A85EC53u};
+    value ^= value >> 33u;
+
+    return value;
+}
+
+auto rotate(const std::uint64_t value, const unsigned bits) noexcept
+    -> std::uint64_t;
+auto rotate(const std::uint64_t value, const unsigned bits) noexcept
+    -> std::uint64_t
+{
+    return (value << bits) | (value >> (64u - bits));
+}
+
+auto digest(const std::string_view text, Cache::Key& state) noexcept -> void;
+auto digest(const std::string_view text, Cache::Key& state) noexcept -> void
+{
+    const auto round = [&](const char* data) {
+        auto lanes = std::array<std::uint64_t, 2>{};
+        std::memcpy(lanes.data(), data, sizeof(lanes));
+
+        for (auto i = std::size_t{0}; i < state.size(); ++i) {
+            state.at(i) =
+                rotate(state.at(i) + (lanes.at(i) * Prime2), 31u) * Prime1;
+        }
+    };
+    constexpr auto block = sizeof(Cache::Key);
+    auto remaining = text.size();
+    const auto* data = text.data();
+
+    for (; remaining >= block; remaining -= block, data += block) {
+        round(data);
+    }
+
+    auto tail = std::array<char, block>{};
+    std::memcpy(tail.data(), data, remaining);
+    round(tail.data());
+    state.at(0) ^= text.size();
+    state.at(1) ^= rotate(text.size(), 32u);
+}
+
+auto write_all(const int fd, const void* data, std::size_t size) noexcept
+    -> bool;
+auto write_all(const int fd, const void* data, std::size_t size) noexcept
+    -> bool
+{
+    const auto* it = static_cast<const char*>(data);
+
+    while (0 < size) {
+        const auto written = ::write(fd, it, size);
+
+        if (0 > written) {
+            if (EINTR == errno) { continue; }
+
+            return false;
+        }
+
+        it += written;
+        size -= static_cast<std::size_t>(written);
+    }
+
+    return true;
+}
+}  // namespace
+
+Cache::Cache(
+    const std::string& directory,
+    const std::uint64_t capacity) noexcept
+    : directory_(directory)
+    , capacity_(capacity)
+{
+}
+
+Cache::Reader::Reader(void* map, const std::size_t size) noexcept
+    : map_(map)
+    , size_(size)
+    , valid_(false)
+    , key_()
+    , count_(0)
+    , errors_(0)
+    , source_lines_(0)
+    , source_size_(0)
+    , text_offset_(0)
+    , text_size_(0)
+    , index_offset_(0)
+    , checkpoint_offset_(0)
+    , checkpoint_size_(0)
+{
+    auto header = Header{};
+
+    if (sizeof(header) > size_) { return; }
+
+    std::memcpy(&header, map_, sizeof(header));
+    const auto indexSize = header.count_ * sizeof(Entry);
+    valid_ = (Magic == header.magic_) &&
+             (header.text_offset_ <= size_) &&
+             (header.text_size_ <= (size_ - header.text_offset_)) &&
+             (0u == (header.index_offset_ % alignof(Entry))) &&
+             (header.index_offset_ <= size_) &&
+             (header.count_ <= (size_ / sizeof(Entry))) &&
+             (indexSize <= (size_ - header.index_offset_)) &&
+             (header.checkpoint_offset_ <= size_) &&
+             (header.checkpoint_size_ <= (size_ - header.checkpoint_offset_));
+
+    if (false == valid_) { return; }
+
+    key_ = header.key_;
+    count_ = header.count_;
+    errors_ = header.errors_;
+    source_lines_ = header.source_lines_;
+    source_size_ = header.source_size_;
+    text_offset_ = header.text_offset_;
+    text_size_ = header.text_size_;
+    index_offset_ = header.index_offset_;
+    checkpoint_offset_ = header.checkpoint_offset_;
+    checkpoint_size_ = header.checkpoint_size_;
+}
+
+auto Cache::Reader::checkpoints() const noexcept -> std::string_view
+{
+    const auto* base = static_cast<const char*>(map_) + checkpoint_offset_;
+
+    return {base, checkpoint_size_};
+}
+
+auto Cache::Reader::entry(const std::size_t index) const noexcept -> Entry
+{
+    auto output = Entry{};
+
+    if (index >= count_) { return output; }
+
+    const auto* base = static_cast<const char*>(map_) + index_offset_;
+    std::memcpy(&output, base + (index * sizeof(output)), sizeof(output));
+
+    return output;
+}
+
+auto Cache::Reader::line(const std::size_t index) const noexcept
+    -> std::string_view
+{
+    const auto item = entry(index);
+
+    if ((item.text_ > text_size_) || (item.size_ > (text_size_ - item.text_))) {
+        return {};
+    }
+
+    const auto* base = static_cast<const char*>(map_) + text_offset_;
+
+    return {base + item.text_, item.size_};
+}
+
+Cache::Reader::~Reader() { ::munmap(map_, size_); }
+
+Cache::Writer::Writer(
+    const Key& key,
+    std::string&& textPath,
+    const int text,
+    std::string&& indexPath,
+    const int index) noexcept
+    : key_(key)
+    , text_path_(std::move(textPath))
+    , index_path_(std::move(indexPath))
+    , text_(text)
+    , index_(index)
+    , text_buffer_()
+    , index_buffer_()
+    , text_size_(0)
+    , count_(0)
+    , failed_(false)
+    , committed_(false)
+{
+    text_buffer_.reserve(FlushSize);
+    index_buffer_.reserve(FlushSize / sizeof(Entry));
+}
+
+auto Cache::Writer::add(
+    const std::string_view line,
+    const std::uint64_t sourceOffset,
+    const std::uint64_t sourceLine) noexcept -> void
+{
+    if (failed_) { return; }
+
+    auto& entry = index_buffer_.emplace_back();
+    entry.text_ = text_size_;
+    entry.source_offset_ = sourceOffset;
+    entry.source_line_ = sourceLine;
+    entry.size_ = static_cast<std::uint32_t>(line.size());
+    text_buffer_.append(line);
+    text_size_ += line.size();
+    ++count_;
+
+    if ((FlushSize <= text_buffer_.size()) ||
+        (index_buffer_.size() == index_buffer_.capacity())) {
+        flush();
+    }
+}
+
+auto Cache::Writer::flush() noexcept -> void
+{
+    failed_ |=
+        (false ==
+         write_all(text_, text_buffer_.data(), text_buffer_.size())) ||
+        (false == write_all(
+                      index_,
+                      index_buffer_.data(),
+                      index_buffer_.size() * sizeof(Entry)));
+    text_buffer_.clear();
+    index_buffer_.clear();
+}
+
+Cache::Writer::~Writer()
+{
+    if (0 <= text_) { ::close(text_); }
+
+    if (0 <= index_) { ::close(index_); }
+
+    if (false == committed_) { ::unlink(text_path_.c_str()); }
+
+    ::unlink(index_path_.c_str());
+}
+
+auto Cache::Hash(
+    const std::string_view text,
+    const std::string_view settings) noexcept -> Key
+{
+    auto state = Key{Prime1, Prime2};
+    digest(text, state);
+    digest(settings, state);
+
+    return {
+        finalize(state.at(0) ^ rotate(state.at(1), 17u)),
+        finalize(state.at(1) + state.at(0))};
+}
+
+auto Cache::commit(
+    std::unique_ptr<Writer> writer,
+    const std::uint64_t errors,
+    const std::uint64_t sourceLines,
+    const std::uint64_t sourceSize,
+    const std::string_view checkpoints) noexcept -> bool
+{
+    if (false == bool(writer)) { return false; }
+
+    auto& entry = *writer;
+    entry.flush();
+    auto header = Header{};
+    header.magic_ = Magic;
+    header.key_ = entry.key_;
+    header.source_size_ = sourceSize;
+    header.source_lines_ = sourceLines;
+    header.errors_ = errors;
+    header.count_ = entry.count_;
+    header.text_offset_ = sizeof(header);
+    header.text_size_ = entry.text_size_;
+    constexpr auto align = alignof(Entry);
+    const auto padding = (align - (entry.text_size_ % align)) % align;
+    header.index_offset_ = header.text_offset_ + entry.text_size_ + padding;
+    header.checkpoint_offset_ =
+        header.index_offset_ + (entry.count_ * sizeof(Entry));
+    header.checkpoint_size_ = checkpoints.size();
+    auto buffer = std::string(FlushSize, '\0');
+    auto failed = entry.failed_ ||
+                  (false == write_all(entry.text_, buffer.data(), padding)) ||
+                  (0 != ::lseek(entry.index_, 0, SEEK_SET));
+
+    // NOTE the index is kept in a separate file while recording so it can be
+    // appended after the text without holding it in memory
+    while (false == failed) {
+        const auto read = ::read(entry.index_, buffer.data(), buffer.size());
+
+        if ((0 > read) && (EINTR == errno)) { continue; }
+
+        if (0 >= read) {
+            failed = (0 > read);
+
+            break;
+        }
+
+        failed = (false == write_all(
+                               entry.text_,
+                               buffer.data(),
+                               static_cast<std::size_t>(read)));
+    }
+
+    failed = failed ||
+             (false ==
+              write_all(entry.text_, checkpoints.data(), checkpoints.size())) ||
+             (static_cast<::ssize_t>(sizeof(header)) !=
+              ::pwrite(entry.text_, &header, sizeof(header), 0)) ||
+             (0 != ::close(entry.text_));
+    entry.text_ = -1;
+
+    if (failed) { return false; }
+
+    if (0 != ::rename(entry.text_path_.c_str(), path(entry.key_).c_str())) {
+        return false;
+    }
+
+    entry.committed_ = true;
+    writer.reset();
+    evict();
+
+    return true;
+}
+
+auto Cache::evict() noexcept -> void
+{
+    if (0u == capacity_) { return; }
+
+    auto* directory = ::opendir(directory_.c_str());
+
+    if (nullptr == directory) { return; }
+
+    // Modification time, size and path of every entry
+    using Item = std::tuple<std::time_t, long, std::uint64_t, std::string>;
+    auto items = std::vector<Item>{};
+    auto total = std::uint64_t{0};
+
+    while (const auto* file = ::readdir(directory)) {
+        const auto name = std::string_view{file->d_name};
+
+        if ((NameSize != name.size()) ||
+            (0 != name.compare(32, Extension.size(), Extension))) {
+            continue;
+        }
+
+        auto path = directory_ + '/' + file->d_name;
+        struct stat info {
+        };
+
+        if ((0 != ::stat(path.c_str(), &info)) ||
+            (false == S_ISREG(info.st_mode))) {
+            continue;
+        }
+
+        const auto size = static_cast<std::uint64_t>(info.st_size);
+        total += size;
+        items.emplace_back(
+            info.st_mtim.tv_sec, info.st_mtim.tv_nsec, size, std::move(path));
+    }
+
+    ::closedir(directory);
+
+    if (total <= capacity_) { return; }
+
+    std::sort(items.begin(), items.end());
+
+    for (const auto& [seconds, nanoseconds, size, path] : items) {
+        if (total <= capacity_) { break; }
+
+        if (0 == ::unlink(path.c_str())) { total -= size; }
+    }
+}
+
+auto Cache::find(const Key& key) noexcept -> std::unique_ptr<Reader>
+{
+    const auto file = path(key);
+    const auto fd = ::open(file.c_str(), O_RDONLY);
+
+    if (0 > fd) { return {}; }
+
+    struct stat info {
+    };
+
+    if ((0 != ::fstat(fd, &info)) || (0 >= info.st_size)) {
+        ::close(fd);
+
+        return {};
+    }
+
+    const auto size = static_cast<std::size_t>(info.st_size);
+    auto* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // NOTE the modification time records the last use for eviction
+    if (MAP_FAILED != map) { ::futimens(fd, nullptr); }
+
+    ::close(fd);
+
+    if (MAP_FAILED == map) { return {}; }
+
+    ::madvise(map, size, MADV_SEQUENTIAL);
+    auto output = std::unique_ptr<Reader>{new Reader{map, size}};
+
+    if ((false == output->valid_) || (key != output->key_)) { return {}; }
+
+    return output;
+}
+
+auto Cache::path(const Key& key) const noexcept -> std::string
+{
+    constexpr auto digits = std::string_view{"0123456789abcdef"};
+    auto output = directory_;
+    output.reserve(output.size() + 1u + NameSize);
+    output.push_back('/');
+
+    for (const auto word : key) {
+        for (auto shift = 64; 0 < shift;) {
+            shift -= 4;
+            output.push_back(digits[(word >> shift) & 0xFu]);
+        }
+    }
+
+    output.append(Extension);
+
+    return output;
+}
+
+auto Cache::record(const Key& key) noexcept -> std::unique_ptr<Writer>
+{
+    auto textPath = directory_ + "/.lsp-XXXXXX";
+    auto indexPath = textPath;
+    const auto text = ::mkstemp(textPath.data());
+
+    if (0 > text) { return {}; }
+
+    const auto index = ::mkstemp(indexPath.data());
+
+    if (0 > index) {
+        ::close(text);
+        ::unlink(textPath.c_str());
+
+        return {};
+    }
+
+    auto output = std::unique_ptr<Writer>{new Writer{
+        key, std::move(textPath), text, std::move(indexPath), index}};
+    const auto header = Header{};
+    output->failed_ = (false == write_all(text, &header, sizeof(header)));
+
+    return output;
+}
+}  // namespace libsubtractive::gcode
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace libsubtractive::gcode
+{
+// On-disk cache of programs in the exact form flow control transmits them,
+// keyed by a hash of the program text and of every setting which affects
+// that form. Each entry is a single file holding the transmitted lines with
+// their terminators followed by an index of line offsets, line lengths and
+// the source position each line was read up to, so a cached program streams
+// from a memory map without lexing, compacting or optimizing it again. The
+// resume checkpoints of the source program are stored after the index since
+// a cached program is never read line by line.
+//
+// Entries are written to temporary files and renamed into place once
+// complete so concurrent readers never see a partial entry. The modification
+// time of an entry records its last use and the least recently used entries
+// are removed whenever the total size exceeds the capacity.
+class Cache
+{
+public:
+    using Key = std::array<std::uint64_t, 2>;
+
+    struct Entry {
+        std::uint64_t text_{};
+        std::uint64_t source_offset_{};
+        std::uint64_t source_line_{};
+        // Including the line terminator
+        std::uint32_t size_{};
+        std::uint32_t reserved_{};
+    };
+
+    // Memory-mapped cache entry
+    class Reader
+    {
+    public:
+        // Serialized Resume checkpoints, empty if none were stored
+        auto checkpoints() const noexcept -> std::string_view;
+        auto count() const noexcept -> std::size_t { return count_; }
+        auto entry(const std::size_t index) const noexcept -> Entry;
+        // Program lines which were not transmitted because they were too long
+        auto errors() const noexcept -> std::uint64_t { return errors_; }
+        // Returns an empty view for a damaged entry
+        auto line(const std::size_t index) const noexcept -> std::string_view;
+        auto source_lines() const noexcept -> std::uint64_t
+        {
+            return source_lines_;
+        }
+        auto source_size() const noexcept -> std::uint64_t
+        {
+            return source_size_;
+        }
+
+        ~Reader();
+
+    private:
+        friend Cache;
+
+        void* map_;
+        const std::size_t size_;
+        bool valid_;
+        Key key_;
+        std::size_t count_;
+        std::uint64_t errors_;
+        std::uint64_t source_lines_;
+        std::uint64_t source_size_;
+        std::uint64_t text_offset_;
+        std::uint64_t text_size_;
+        std::uint64_t index_offset_;
+        std::uint64_t checkpoint_offset_;
+        std::uint64_t checkpoint_size_;
+
+        Reader(void* map, const std::size_t size) noexcept;
+        Reader() = delete;
+        Reader(const Reader&) = delete;
+        Reader(Reader&&) = delete;
+        auto operator=(const Reader&) -> Reader& = delete;
+        auto operator=(Reader&&) -> Reader& = delete;
+    };
+
+    // Cache entry under construction. Destroying a writer which was not
+    // committed discards the entry.
+    class Writer
+    {
+    public:
+        // Line must include its terminator
+        auto add(
+            const std::string_view line,
+            const std::uint64_t sourceOffset,
+            const std::uint64_t sourceLine) noexcept -> void;
+
+        ~Writer();
+
+    private:
+        friend Cache;
+
+        const Key key_;
+        const std::string text_path_;
+        const std::string index_path_;
+        int text_;
+        int index_;
+        std::string text_buffer_;
+        std::vector<Entry> index_buffer_;
+        std::uint64_t text_size_;
+        std::uint64_t count_;
+        bool failed_;
+        bool committed_;
+
+        auto flush() noexcept -> void;
+
+        Writer(
+            const Key& key,
+            std::string&& textPath,
+            const int text,
+            std::string&& indexPath,
+            const int index) noexcept;
+        Writer() = delete;
+        Writer(const Writer&) = delete;
+        Writer(Writer&&) = delete;
+        auto operator=(const Writer&) -> Writer& = delete;
+        auto operator=(Writer&&) -> Writer& = delete;
+    };
+
+    // Non-cryptographic 128 bit hash of a program and the settings used to
+    // preprocess it
+    static auto Hash(
+        const std::string_view text,
+        const std::string_view settings) noexcept -> Key;
+
+    // Completes an entry and evicts old entries if the cache is over capacity
+    auto commit(
+        std::unique_ptr<Writer> writer,
+        const std::uint64_t errors,
+        const std::uint64_t sourceLines,
+        const std::uint64_t sourceSize,
+        const std::string_view checkpoints = {}) noexcept -> bool;
+    auto evict() noexcept -> void;
+    // Returns nothing if the entry does not exist or is not valid
+    auto find(const Key& key) noexcept -> std::unique_ptr<Reader>;
+    auto record(const Key& key) noexcept -> std::unique_ptr<Writer>;
+
+    // A capacity of 0 bytes disables eviction
+    Cache(const std::string& directory, const std::uint64_t capacity) noexcept;
+
+private:
+    const std::string directory_;
+    const std::uint64_t capacity_;
+
+    auto path(const Key& key) const noexcept -> std::string;
+};
+}  // namespace libsubtractive::gcode
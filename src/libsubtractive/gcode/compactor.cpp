@@ -0,0 +1,210 @@
+#include "libsubtractive/gcode/compactor.hpp"  // IWYU pragma: associated
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+
+#include "libsubtractive/gcode/format.hpp"
+
+namespace libsubtractive::gcode
+{
+namespace
+{
+enum Group : std::size_t {
+    Motion,
+    Plane,
+    Distance,
+    FeedMode,
+    Units,
+    Coordinates,
+};
+
+constexpr auto Unknown = int{-1};
+constexpr auto MaxPrecision = int{9};
+constexpr auto RoundedLetters = std::string_view{"XYZABCIJKR"};
+
+// G codes are keyed by ten times their value so G38.2 is 382
+auto code(const double value) noexcept -> int;
+auto code(const double value) noexcept -> int
+{
+    return static_cast<int>(std::lround(value * 10.0));
+}
+
+// Returns the index of the modal group for a G code, or nothing for codes
+// which are not tracked
+auto group(const int code) noexcept -> std::optional<std::size_t>;
+auto group(const int code) noexcept -> std::optional<std::size_t>
+{
+    switch (code) {
+        case 0:
+        case 10:
+        case 20:
+        case 30:
+        case 382:
+        case 383:
+        case 384:
+        case 385:
+        case 800: {
+            return Motion;
+        }
+        case 170:
+        case 180:
+        case 190: {
+            return Plane;
+        }
+        case 900:
+        case 910: {
+            return Distance;
+        }
+        case 930:
+        case 940: {
+            return FeedMode;
+        }
+        case 200:
+        case 210: {
+            return Units;
+        }
+        case 540:
+        case 550:
+        case 560:
+        case 570:
+        case 580:
+        case 590: {
+            return Coordinates;
+        }
+        default: {
+            return std::nullopt;
+        }
+    }
+}
+
+}  // namespace
+
+Compactor::Compactor(const int precision) noexcept
+    : precision_(std::min(precision, MaxPrecision))
+    , lex_()
+    , modes_()
+    , feed_()
+    , feed_known_()
+    , stats_()
+{
+    reset();
+}
+
+auto Compactor::append_number(const Word& word, std::string& out) const noexcept
+    -> void
+{
+    const auto axis = RoundedLetters.find(word.letter_);
+    const auto round = (0 <= precision_) && (std::string_view::npos != axis);
+
+    if (false == round) {
+        append_trimmed(word.text_, out);
+
+        return;
+    }
+
+    if (false == append_decimal(word.value_, precision_, out)) {
+        append_trimmed(word.text_, out);
+    }
+}
+
+auto Compactor::append_message(std::string& out) const noexcept -> void
+{
+    const auto message = lex_.message();
+
+    if (0 == message.size()) { return; }
+
+    out.append("(MSG,");
+    out.append(message);
+    out.push_back(')');
+}
+
+auto Compactor::block(std::string& out) noexcept -> void
+{
+    const auto& words = lex_.words();
+    auto next = modes_;
+    auto programEnd{false};
+
+    for (const auto& word : words) {
+        if ('G' == word.letter_) {
+            const auto value = code(word.value_);
+
+            if (const auto index = group(value); index.has_value()) {
+                next.at(index.value()) = value;
+            }
+        } else if ('M' == word.letter_) {
+            const auto value = code(word.value_);
+            programEnd |= (20 == value) || (300 == value);
+        }
+    }
+
+    // NOTE inverse time mode requires an F word on every motion block
+    const auto inverseTime = (930 == next.at(FeedMode));
+
+    // NOTE an F word is read in the units of its own block, so the same
+    // number after G20 or G21 is a different feed rate
+    if (modes_.at(Units) != next.at(Units)) { feed_known_ = false; }
+
+    for (const auto& word : words) {
+        if ('G' == word.letter_) {
+            const auto value = code(word.value_);
+            const auto index = group(value);
+
+            if (index.has_value() && (modes_.at(index.value()) == value)) {
+                continue;
+            }
+        } else if ('F' == word.letter_) {
+            const auto repeated = feed_known_ && (feed_ == word.value_);
+
+            feed_ = word.value_;
+            feed_known_ = true;
+
+            if (repeated && (false == inverseTime)) { continue; }
+        }
+
+        out.push_back(word.letter_);
+        append_number(word, out);
+    }
+
+    modes_ = next;
+
+    // NOTE the meaning of F changes along with the feed rate mode
+    if (inverseTime) { feed_known_ = false; }
+
+    // NOTE M2 and M30 restore several modes to values which depend on the
+    // controller configuration
+    if (programEnd) { reset(); }
+}
+
+auto Compactor::operator()(
+    const std::string_view line,
+    std::string& out) noexcept -> void
+{
+    out.clear();
+
+    switch (lex_(line)) {
+        case Lexer::Type::Block: {
+            block(out);
+            append_message(out);
+        } break;
+        case Lexer::Type::Other: {
+            out.append(lex_.text());
+        } break;
+        case Lexer::Type::Empty:
+        default: {
+            append_message(out);
+        }
+    }
+
+    ++stats_.lines_;
+    stats_.bytes_in_ += line.size() + 1u;
+    stats_.bytes_out_ += (0 < out.size()) ? out.size() + 1u : 0u;
+}
+
+auto Compactor::reset() noexcept -> void
+{
+    modes_.fill(Unknown);
+    feed_ = 0.0;
+    feed_known_ = false;
+}
+}  // namespace libsubtractive::gcode
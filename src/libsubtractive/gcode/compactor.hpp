@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "libsubtractive/gcode/lexer.hpp"
+
+namespace libsubtractive::gcode
+{
+// Rewrites G-code lines into the fewest bytes Grbl will execute identically.
+// Comments and whitespace are removed, numbers lose redundant zeros, G words
+// which repeat the active mode of their modal group and F words which repeat
+// the active feed rate are dropped, and coordinates are optionally rounded.
+//
+// Modal state is tracked from the lines passed through the compactor so every
+// line sent to a controller must pass through it in order, and reset() must be
+// called whenever the controller state may have changed some other way (soft
+// reset, alarm, error response, reconnection).
+class Compactor
+{
+public:
+    struct Statistics {
+        std::uint64_t lines_{};
+        // Byte counts include one line terminator per non-empty line
+        std::uint64_t bytes_in_{};
+        std::uint64_t bytes_out_{};
+    };
+
+    auto precision() const noexcept -> int { return precision_; }
+    auto statistics() const noexcept -> const Statistics& { return stats_; }
+
+    // Writes the compacted form of line without a line terminator to out. An
+    // empty result means the line contains nothing to execute.
+    auto operator()(const std::string_view line, std::string& out) noexcept
+        -> void;
+
+    auto reset() noexcept -> void;
+
+    // Coordinates are rounded to precision digits after the decimal point.
+    // A negative precision keeps every digit.
+    Compactor(const int precision) noexcept;
+
+private:
+    // Active G code of the motion, plane, distance, feed rate mode, units and
+    // coordinate system modal groups
+    using Modes = std::array<int, 6>;
+
+    const int precision_;
+    Lexer lex_;
+    Modes modes_;
+    double feed_;
+    bool feed_known_;
+    Statistics stats_;
+
+    auto append_number(const Word& word, std::string& out) const noexcept
+        -> void;
+    auto append_message(std::string& out) const noexcept -> void;
+    auto block(std::string& out) noexcept -> void;
+};
+}  // namespace libsubtractive::gcode
@@ -0,0 +1,96 @@
+#include "libsubtractive/gcode/format.hpp"  // IWYU pragma: associated
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+
+namespace libsubtractive::gcode
+{
+// NOTE scaled integer formatting is independent of the global locale
+auto append_decimal(
+    const double value,
+    const int precision,
+    std::string& out) noexcept -> bool
+{
+    auto scale = 1.0;
+
+    for (auto i = 0; i < precision; ++i) { scale *= 10.0; }
+
+    const auto scaled = value * scale;
+    constexpr auto limit =
+        static_cast<double>(std::numeric_limits<long long>::max());
+
+    if ((false == std::isfinite(scaled)) || (limit <= std::abs(scaled))) {
+        return false;
+    }
+
+    const auto rounded = std::llround(scaled);
+    auto digits = std::array<char, 32>{};
+    auto text = std::array<char, 48>{};
+    const auto [end, error] = std::to_chars(
+        digits.data(), digits.data() + digits.size(), std::llabs(rounded));
+
+    if (std::errc{} != error) { return false; }
+
+    const auto* begin = digits.data();
+    const auto* last = static_cast<const char*>(end);
+    const auto length = static_cast<std::size_t>(last - begin);
+    const auto fraction = static_cast<std::size_t>(std::max(precision, 0));
+    auto* it = text.data();
+
+    if (0 > rounded) { *it++ = '-'; }
+
+    if (length <= fraction) {
+        *it++ = '.';
+        it = std::fill_n(it, fraction - length, '0');
+        it = std::copy(begin, last, it);
+    } else {
+        it = std::copy(begin, begin + (length - fraction), it);
+        *it++ = '.';
+        it = std::copy(begin + (length - fraction), last, it);
+    }
+
+    append_trimmed(
+        {text.data(), static_cast<std::size_t>(it - text.data())}, out);
+
+    return true;
+}
+
+auto append_trimmed(std::string_view text, std::string& out) noexcept -> void
+{
+    auto negative{false};
+
+    if ((0 < text.size()) && (('-' == text[0]) || ('+' == text[0]))) {
+        negative = ('-' == text[0]);
+        text.remove_prefix(1);
+    }
+
+    while ((0 < text.size()) && ('0' == text.front())) {
+        text.remove_prefix(1);
+    }
+
+    if (std::string_view::npos != text.find('.')) {
+        while ((0 < text.size()) && ('0' == text.back())) {
+            text.remove_suffix(1);
+        }
+
+        if ((0 < text.size()) && ('.' == text.back())) {
+            text.remove_suffix(1);
+        }
+    }
+
+    if (0 == text.size()) {
+        out.push_back('0');
+
+        return;
+    }
+
+    if (negative) { out.push_back('-'); }
+
+    out.append(text);
+}
+}  // namespace libsubtractive::gcode
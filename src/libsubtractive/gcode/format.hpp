@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace libsubtractive::gcode
+{
+// Appends value rounded to precision digits after the decimal point, without
+// redundant zeros. Returns false without modifying out if value can not be
+// represented.
+auto append_decimal(
+    const double value,
+    const int precision,
+    std::string& out) noexcept -> bool;
+// Appends a number after removing a leading plus sign, leading zeros of the
+// integer part, trailing zeros of the fraction and a bare decimal point.
+// Negative zero becomes 0.
+auto append_trimmed(std::string_view text, std::string& out) noexcept -> void;
+}  // namespace libsubtractive::gcode
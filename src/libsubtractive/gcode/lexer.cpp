@@ -0,0 +1,104 @@
+#include "libsubtractive/gcode/lexer.hpp"  // IWYU pragma: associated
+
+#include <cctype>
+#include <cstddef>
+
+#include "libsubtractive/protocol/Grbl.hpp"
+
+namespace libsubtractive::gcode
+{
+constexpr auto MessagePrefix = std::string_view{"MSG,"};
+
+Lexer::Lexer() noexcept
+    : clean_()
+    , message_()
+    , text_()
+    , words_()
+{
+}
+
+auto Lexer::operator()(const std::string_view line) noexcept -> Type
+{
+    clean_.clear();
+    words_.clear();
+    message_ = {};
+    text_ = line;
+
+    const auto space = [](const char c) {
+        return 0 != std::isspace(static_cast<unsigned char>(c));
+    };
+
+    while ((0 < text_.size()) && space(text_.front())) {
+        text_.remove_prefix(1);
+    }
+
+    while ((0 < text_.size()) && space(text_.back())) {
+        text_.remove_suffix(1);
+    }
+
+    if (0 == text_.size()) { return Type::Empty; }
+
+    switch (text_.front()) {
+        case '$':
+        case '[':
+        case '%': {
+            return Type::Other;
+        }
+        default: {
+        }
+    }
+
+    auto comment = std::string_view::npos;
+
+    for (auto i = std::size_t{0}; i < text_.size(); ++i) {
+        const auto c = text_[i];
+
+        if (std::string_view::npos != comment) {
+            if (')' == c) {
+                const auto body = text_.substr(comment + 1u, i - comment - 1u);
+
+                if (0 == body.compare(0, MessagePrefix.size(), MessagePrefix)) {
+                    message_ = body.substr(MessagePrefix.size());
+                }
+
+                comment = std::string_view::npos;
+            }
+        } else if ('(' == c) {
+            comment = i;
+        } else if (';' == c) {
+            break;
+        } else if (false == space(c)) {
+            clean_.push_back(static_cast<char>(
+                std::toupper(static_cast<unsigned char>(c))));
+        }
+    }
+
+    if (std::string_view::npos != comment) { return Type::Other; }
+
+    if (clean_.empty()) { return Type::Empty; }
+
+    const auto clean = std::string_view{clean_};
+
+    for (auto i = std::size_t{0}; i < clean.size();) {
+        const auto letter = clean[i++];
+
+        if (('A' > letter) || ('Z' < letter)) { return Type::Other; }
+
+        const auto start = i;
+
+        while ((i < clean.size()) && (('A' > clean[i]) || ('Z' < clean[i]))) {
+            ++i;
+        }
+
+        auto& word = words_.emplace_back();
+        word.letter_ = letter;
+        word.text_ = clean.substr(start, i - start);
+
+        if (false == grbl::parse_number(word.text_, word.value_)) {
+            return Type::Other;
+        }
+    }
+
+    return Type::Block;
+}
+}  // namespace libsubtractive::gcode
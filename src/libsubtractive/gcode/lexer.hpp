@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace libsubtractive::gcode
+{
+struct Word {
+    char letter_{};
+    // Number exactly as written, minus whitespace
+    std::string_view text_{};
+    double value_{};
+};
+
+// Splits one line of G-code into words. Whitespace and comments are removed
+// and letters are converted to upper case. Buffers are reused between lines
+// so lexing does not allocate once they have grown to the longest line.
+class Lexer
+{
+public:
+    enum class Type : std::uint8_t {
+        Empty,
+        // Blocks which are not G-code, such as $ system commands, or which
+        // could not be lexed. text() holds the line without surrounding
+        // whitespace so Grbl can respond to it as usual.
+        Other,
+        Block,
+    };
+
+    // Text of a (MSG,...) comment, which Grbl prints when it executes the
+    // block
+    auto message() const noexcept -> std::string_view { return message_; }
+    auto text() const noexcept -> std::string_view { return text_; }
+    auto words() const noexcept -> const std::vector<Word>& { return words_; }
+
+    auto operator()(const std::string_view line) noexcept -> Type;
+
+    Lexer() noexcept;
+
+private:
+    std::string clean_;
+    std::string_view message_;
+    std::string_view text_;
+    std::vector<Word> words_;
+};
+}  // namespace libsubtractive::gcode
@@ -0,0 +1,506 @@
+#include "libsubtractive/gcode/optimizer.hpp"  // IWYU pragma: associated
+
+#include <cmath>
+#include <utility>
+
+#include "libsubtractive/gcode/format.hpp"
+
+namespace libsubtractive::gcode
+{
+namespace
+{
+constexpr auto Unknown = int{-1};
+constexpr auto UnknownFeed = -1.0;
+// Digits after the decimal point of generated coordinates
+constexpr auto OutputPrecision = int{4};
+// Bounds the cost of refitting a run each time it grows
+constexpr auto MaxRun = std::size_t{64};
+// An arc replacing fewer segments than this is longer than the segments
+constexpr auto MinArcSegments = std::size_t{3};
+constexpr auto MaxRadius = 10000.0;
+constexpr auto Pi = 3.14159265358979323846;
+
+// G codes are keyed by ten times their value so G38.2 is 382
+auto code(const double value) noexcept -> int;
+auto code(const double value) noexcept -> int
+{
+    return static_cast<int>(std::lround(value * 10.0));
+}
+
+auto append_code(const int value, std::string& out) noexcept -> void;
+auto append_code(const int value, std::string& out) noexcept -> void
+{
+    out.push_back('G');
+    out.append(std::to_string(value / 10));
+
+    if (0 != (value % 10)) {
+        out.push_back('.');
+        out.append(std::to_string(value % 10));
+    }
+}
+}  // namespace
+
+Optimizer::Optimizer(const double tolerance) noexcept
+    : tolerance_(tolerance)
+    , lex_()
+    , output_()
+    , run_()
+    , fit_(Fit::None)
+    , center_()
+    , clockwise_(false)
+    , position_()
+    , known_()
+    , motion_in_(Unknown)
+    , motion_out_(Unknown)
+    , distance_(Unknown)
+    , plane_(Unknown)
+    , feed_mode_(Unknown)
+    , feed_(UnknownFeed)
+    , feed_pending_(false)
+    , stats_()
+{
+    run_.reserve(MaxRun + 1u);
+}
+
+auto Optimizer::emit() noexcept -> void
+{
+    if (2 > run_.size()) { return; }
+
+    const auto write = [this](
+                           const int motion,
+                           const Point& from,
+                           const Point& to,
+                           const bool arc) {
+        auto line = std::string{};
+        append_code(motion, line);
+
+        if (arc || (to.x_ != from.x_)) {
+            line.push_back('X');
+            append_decimal(to.x_, OutputPrecision, line);
+        }
+
+        if (arc || (to.y_ != from.y_)) {
+            line.push_back('Y');
+            append_decimal(to.y_, OutputPrecision, line);
+        }
+
+        if (to.z_ != from.z_) {
+            line.push_back('Z');
+            append_decimal(to.z_, OutputPrecision, line);
+        }
+
+        if (arc) {
+            line.push_back('I');
+            append_decimal(center_.x_ - from.x_, OutputPrecision, line);
+            line.push_back('J');
+            append_decimal(center_.y_ - from.y_, OutputPrecision, line);
+        }
+
+        if (feed_pending_) {
+            line.push_back('F');
+            append_decimal(feed_, OutputPrecision, line);
+            feed_pending_ = false;
+        }
+
+        output_.emplace_back(std::move(line));
+        ++stats_.lines_out_;
+        motion_out_ = motion;
+    };
+    const auto segments = run_.size() - 1u;
+
+    if ((Fit::Arc == fit_) && (MinArcSegments <= segments)) {
+        write(clockwise_ ? 20 : 30, run_.front(), run_.back(), true);
+        ++stats_.arcs_;
+    } else if ((Fit::Line == fit_) && (1u < segments)) {
+        write(10, run_.front(), run_.back(), false);
+        ++stats_.lines_;
+    } else {
+        for (auto i = std::size_t{1}; i < run_.size(); ++i) {
+            write(10, run_.at(i - 1u), run_.at(i), false);
+        }
+    }
+
+    run_.erase(run_.begin(), std::prev(run_.end()));
+    fit_ = Fit::None;
+}
+
+auto Optimizer::empty() const noexcept -> bool
+{
+    return output_.empty() && (2 > run_.size());
+}
+
+auto Optimizer::extend(const Point& target) noexcept -> void
+{
+    if (run_.empty()) { run_.emplace_back(position_); }
+
+    run_.emplace_back(target);
+
+    if (2 == run_.size()) {
+        fit_ = Fit::Line;
+
+        return;
+    }
+
+    if (MaxRun >= run_.size()) {
+        if ((Fit::Line == fit_) && fits_line()) { return; }
+
+        if (fits_arc()) {
+            fit_ = Fit::Arc;
+
+            return;
+        }
+    }
+
+    // NOTE target does not fit the current run so it starts the next one
+    run_.pop_back();
+    emit();
+    run_.emplace_back(target);
+    fit_ = Fit::Line;
+}
+
+auto Optimizer::fits_arc() noexcept -> bool
+{
+    if ((170 != plane_) || (3 > run_.size())) { return false; }
+
+    const auto& a = run_.front();
+    const auto& m = run_.at(run_.size() / 2u);
+    const auto& b = run_.back();
+
+    for (const auto& point : run_) {
+        if (point.z_ != a.z_) { return false; }
+    }
+
+    // NOTE circle through a, m and b computed relative to a for precision
+    const auto mx = m.x_ - a.x_;
+    const auto my = m.y_ - a.y_;
+    const auto bx = b.x_ - a.x_;
+    const auto by = b.y_ - a.y_;
+    const auto d = 2.0 * ((mx * by) - (my * bx));
+
+    if (std::abs(d) < 1e-12) { return false; }
+
+    const auto m2 = (mx * mx) + (my * my);
+    const auto b2 = (bx * bx) + (by * by);
+    const auto cx = ((by * m2) - (my * b2)) / d;
+    const auto cy = ((mx * b2) - (bx * m2)) / d;
+    const auto radius = std::hypot(cx, cy);
+
+    if (MaxRadius < radius) { return false; }
+
+    auto sweep = 0.0;
+    auto previous = std::atan2(-cy, -cx);
+
+    for (auto i = std::size_t{1}; i < run_.size(); ++i) {
+        const auto x = run_.at(i).x_ - a.x_ - cx;
+        const auto y = run_.at(i).y_ - a.y_ - cy;
+
+        if (tolerance_ < std::abs(std::hypot(x, y) - radius)) { return false; }
+
+        const auto angle = std::atan2(y, x);
+        auto delta = angle - previous;
+
+        if (Pi < delta) { delta -= 2.0 * Pi; }
+
+        if (-Pi > delta) { delta += 2.0 * Pi; }
+
+        const auto reversed = (0.0 != sweep) && ((delta < 0) != (sweep < 0));
+
+        if ((0.0 == delta) || reversed) { return false; }
+
+        // NOTE the original segment is a chord so it strays from the arc by
+        // the sagitta
+        const auto sagitta = radius * (1.0 - std::cos(std::abs(delta) / 2.0));
+
+        if (tolerance_ < sagitta) { return false; }
+
+        sweep += delta;
+        previous = angle;
+    }
+
+    if ((2.0 * Pi) <= (std::abs(sweep) + 1e-6)) { return false; }
+
+    center_ = {a.x_ + cx, a.y_ + cy, a.z_};
+    clockwise_ = (0 > sweep);
+
+    return true;
+}
+
+auto Optimizer::fits_line() const noexcept -> bool
+{
+    const auto& a = run_.front();
+    const auto& b = run_.back();
+    const auto dx = b.x_ - a.x_;
+    const auto dy = b.y_ - a.y_;
+    const auto dz = b.z_ - a.z_;
+    const auto length = (dx * dx) + (dy * dy) + (dz * dz);
+
+    if (0.0 == length) { return false; }
+
+    auto previous = 0.0;
+
+    for (auto i = std::size_t{1}; (i + 1u) < run_.size(); ++i) {
+        const auto& p = run_.at(i);
+        const auto px = p.x_ - a.x_;
+        const auto py = p.y_ - a.y_;
+        const auto pz = p.z_ - a.z_;
+        const auto t = ((px * dx) + (py * dy) + (pz * dz)) / length;
+
+        // NOTE reversals along the same line must be preserved
+        if ((t < previous) || (1.0 < t)) { return false; }
+
+        const auto ex = px - (t * dx);
+        const auto ey = py - (t * dy);
+        const auto ez = pz - (t * dz);
+
+        if ((tolerance_ * tolerance_) < ((ex * ex) + (ey * ey) + (ez * ez))) {
+            return false;
+        }
+
+        previous = t;
+    }
+
+    return true;
+}
+
+auto Optimizer::flush() noexcept -> void
+{
+    emit();
+    run_.clear();
+}
+
+auto Optimizer::next(std::string& out) noexcept -> bool
+{
+    if (output_.empty()) { return false; }
+
+    out = std::move(output_.front());
+    output_.pop_front();
+
+    return true;
+}
+
+auto Optimizer::optimizable() const noexcept -> bool
+{
+    if ((900 != distance_) || (930 == feed_mode_)) { return false; }
+
+    if (0 < lex_.message().size()) { return false; }
+
+    if ((false == known_[0]) || (false == known_[1]) || (false == known_[2])) {
+        return false;
+    }
+
+    auto motion = motion_in_;
+    auto axes{false};
+
+    for (const auto& word : lex_.words()) {
+        switch (word.letter_) {
+            case 'G': {
+                motion = code(word.value_);
+
+                if (10 != motion) { return false; }
+            } break;
+            case 'X':
+            case 'Y':
+            case 'Z': {
+                axes = true;
+            } break;
+            case 'F': {
+            } break;
+            default: {
+                return false;
+            }
+        }
+    }
+
+    return axes && (10 == motion);
+}
+
+// Tracks the modal state and position set by a line which is not optimized
+// and emits it. Anything which may change the meaning of coordinates makes
+// the position unknown until every axis is set again.
+auto Optimizer::pass(const std::string_view line) noexcept -> void
+{
+    auto motion{false};
+    auto axes{false};
+    auto lost{false};
+    // NOTE axis words of G10, G28, G30 and G92 are not moves in the current
+    // motion mode, so restating the mode for them would change the block
+    auto nonModal{false};
+
+    for (const auto& word : lex_.words()) {
+        if ('M' == word.letter_) {
+            const auto value = code(word.value_);
+
+            // NOTE M2 and M30 restore modes to configuration dependent values
+            if ((20 == value) || (300 == value)) {
+                motion_in_ = Unknown;
+                distance_ = Unknown;
+                plane_ = Unknown;
+                feed_mode_ = Unknown;
+            }
+        }
+
+        if ('G' != word.letter_) { continue; }
+
+        switch (const auto value = code(word.value_); value) {
+            case 0:
+            case 10:
+            case 20:
+            case 30:
+            case 800: {
+                motion_in_ = value;
+                motion = true;
+            } break;
+            case 382:
+            case 383:
+            case 384:
+            case 385: {
+                motion_in_ = value;
+                motion = true;
+                lost = true;
+            } break;
+            case 170:
+            case 180:
+            case 190: {
+                plane_ = value;
+            } break;
+            case 900:
+            case 910: {
+                distance_ = value;
+            } break;
+            case 930:
+            case 940: {
+                feed_mode_ = value;
+            } break;
+            case 40:
+            case 610: {
+            } break;
+            case 100:
+            case 280:
+            case 281:
+            case 300:
+            case 301:
+            case 920:
+            case 921: {
+                nonModal = true;
+                lost = true;
+            } break;
+            default: {
+                lost = true;
+            }
+        }
+    }
+
+    for (const auto& word : lex_.words()) {
+        auto index = std::size_t{0};
+        auto* axis = &position_.x_;
+
+        switch (word.letter_) {
+            case 'X': {
+                index = 0;
+                axis = &position_.x_;
+            } break;
+            case 'Y': {
+                index = 1;
+                axis = &position_.y_;
+            } break;
+            case 'Z': {
+                index = 2;
+                axis = &position_.z_;
+            } break;
+            case 'F': {
+                feed_ = word.value_;
+                feed_pending_ = false;
+
+                continue;
+            }
+            default: {
+                continue;
+            }
+        }
+
+        axes = true;
+
+        if (900 == distance_) {
+            *axis = word.value_;
+            known_.at(index) = true;
+        } else if (910 == distance_) {
+            *axis += word.value_;
+        } else {
+            known_.at(index) = false;
+        }
+    }
+
+    if (lost) { known_.fill(false); }
+
+    auto output = std::string{};
+
+    if (nonModal) { axes = false; }
+
+    if (axes && (false == motion) && (motion_in_ != motion_out_) &&
+        (Unknown != motion_in_)) {
+        append_code(motion_in_, output);
+    }
+
+    if (axes || motion) { motion_out_ = motion_in_; }
+
+    output.append(line);
+    output_.emplace_back(std::move(output));
+    ++stats_.lines_out_;
+}
+
+auto Optimizer::push(const std::string_view line) noexcept -> void
+{
+    ++stats_.lines_in_;
+
+    const auto type = lex_(line);
+
+    if ((Lexer::Type::Block == type) && optimizable()) {
+        auto target = position_;
+        auto feed = feed_;
+
+        for (const auto& word : lex_.words()) {
+            switch (word.letter_) {
+                case 'X': {
+                    target.x_ = word.value_;
+                } break;
+                case 'Y': {
+                    target.y_ = word.value_;
+                } break;
+                case 'Z': {
+                    target.z_ = word.value_;
+                } break;
+                case 'F': {
+                    feed = word.value_;
+                } break;
+                default: {
+                }
+            }
+        }
+
+        motion_in_ = 10;
+
+        if (feed != feed_) {
+            flush();
+            feed_ = feed;
+            feed_pending_ = true;
+        }
+
+        extend(target);
+        position_ = target;
+
+        return;
+    }
+
+    flush();
+
+    if (Lexer::Type::Block == type) {
+        pass(line);
+    } else {
+        // NOTE system commands such as $H and $J= move the machine
+        if (Lexer::Type::Other == type) { known_.fill(false); }
+
+        output_.emplace_back(line);
+        ++stats_.lines_out_;
+    }
+}
+}  // namespace libsubtractive::gcode
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "libsubtractive/gcode/lexer.hpp"
+
+namespace libsubtractive::gcode
+{
+// Streaming toolpath optimizer for programs made of many short G1 moves.
+// Consecutive moves at the same feed rate are buffered and replaced by a
+// single G1 when every intermediate point lies within tolerance of the
+// resulting line, or by a single G2/G3 when they lie within tolerance of an
+// arc in the XY plane.
+//
+// Only simple moves (G1 with X, Y, Z and F words) in absolute distance mode
+// from a known position are optimized. Every other line flushes the buffered
+// moves and is passed through unchanged.
+class Optimizer
+{
+public:
+    struct Statistics {
+        std::uint64_t lines_in_{};
+        std::uint64_t lines_out_{};
+        std::uint64_t arcs_{};
+        std::uint64_t lines_{};
+    };
+
+    // True when neither output lines nor buffered moves remain
+    auto empty() const noexcept -> bool;
+    auto statistics() const noexcept -> const Statistics& { return stats_; }
+
+    // Emits every buffered move. Call at the end of the program.
+    auto flush() noexcept -> void;
+    // Removes the next output line. Returns false if none is ready.
+    auto next(std::string& out) noexcept -> bool;
+    auto push(const std::string_view line) noexcept -> void;
+
+    // Tolerance is the maximum distance, in program units, between the
+    // original path and its replacement
+    Optimizer(const double tolerance) noexcept;
+
+private:
+    enum class Fit : std::uint8_t { None, Line, Arc };
+
+    struct Point {
+        double x_{};
+        double y_{};
+        double z_{};
+    };
+
+    double tolerance_;
+    Lexer lex_;
+    std::deque<std::string> output_;
+    std::vector<Point> run_;
+    Fit fit_;
+    Point center_;
+    bool clockwise_;
+    Point position_;
+    std::array<bool, 3> known_;
+    int motion_in_;
+    int motion_out_;
+    int distance_;
+    int plane_;
+    int feed_mode_;
+    double feed_;
+    bool feed_pending_;
+    Statistics stats_;
+
+    auto emit() noexcept -> void;
+    auto extend(const Point& target) noexcept -> void;
+    auto fits_arc() noexcept -> bool;
+    auto fits_line() const noexcept -> bool;
+    auto optimizable() const noexcept -> bool;
+    auto pass(const std::string_view line) noexcept -> void;
+};
+}  // namespace libsubtractive::gcode
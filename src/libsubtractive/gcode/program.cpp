@@ -0,0 +1,146 @@
+#include "libsubtractive/gcode/program.hpp"  // IWYU pragma: associated
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+
+namespace libsubtractive::gcode
+{
+// Pages behind the read position are returned to the kernel in blocks of this
+// size so the resident size of a mapped program stays constant
+constexpr auto ReleaseInterval = std::size_t{16u * 1024u * 1024u};
+
+// NOTE zmq stores short messages inside the frame itself, so the text of a
+// buffered program is only viewed once the frame has reached frame_
+Program::Program(
+    std::optional<zmq::Frame>&& frame,
+    void* map,
+    const std::size_t mapSize,
+    const std::string_view text,
+    std::string&& identity) noexcept
+    : frame_(std::move(frame))
+    , map_(map)
+    , map_size_(mapSize)
+    , text_(frame_.has_value() ? frame_->str() : text)
+    , identity_(std::move(identity))
+    , offset_(0)
+    , line_(0)
+    , released_(0)
+{
+}
+
+auto Program::Buffer(zmq::Frame&& text) noexcept -> std::unique_ptr<Program>
+{
+    return std::unique_ptr<Program>{
+        new Program{std::move(text), nullptr, 0, {}, {}}};
+}
+
+auto Program::Map(const std::string& path) noexcept -> std::unique_ptr<Program>
+{
+    const auto fd = ::open(path.c_str(), O_RDONLY);
+
+    if (0 > fd) { return {}; }
+
+    struct stat info {
+    };
+
+    if ((0 != ::fstat(fd, &info)) || (0 > info.st_size)) {
+        ::close(fd);
+
+        return {};
+    }
+
+    const auto size = static_cast<std::size_t>(info.st_size);
+    void* map{nullptr};
+
+    if (0 < size) {
+        map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (MAP_FAILED == map) {
+            ::close(fd);
+
+            return {};
+        }
+
+        ::madvise(map, size, MADV_SEQUENTIAL);
+    }
+
+    ::close(fd);
+    auto identity = path;
+    identity.push_back('\0');
+    identity.append(std::to_string(info.st_dev));
+    identity.push_back(':');
+    identity.append(std::to_string(info.st_ino));
+    identity.push_back(':');
+    identity.append(std::to_string(size));
+    identity.push_back(':');
+    identity.append(std::to_string(info.st_mtim.tv_sec));
+    identity.push_back('.');
+    identity.append(std::to_string(info.st_mtim.tv_nsec));
+
+    return std::unique_ptr<Program>{new Program{
+        std::nullopt,
+        map,
+        size,
+        {static_cast<const char*>(map), size},
+        std::move(identity)}};
+}
+
+auto Program::next(std::string_view& line) noexcept -> bool
+{
+    if (offset_ >= text_.size()) { return false; }
+
+    const auto* begin = text_.data() + offset_;
+    const auto remaining = text_.size() - offset_;
+    const auto* eol =
+        static_cast<const char*>(std::memchr(begin, '\n', remaining));
+    const auto length = (nullptr == eol)
+                            ? remaining
+                            : static_cast<std::size_t>(eol - begin);
+    offset_ += (nullptr == eol) ? length : length + 1u;
+    line = {begin, length};
+
+    if ((0 < line.size()) && ('\r' == line.back())) { line.remove_suffix(1); }
+
+    ++line_;
+    release();
+
+    return true;
+}
+
+auto Program::release() noexcept -> void
+{
+    if (nullptr == map_) { return; }
+
+    const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const auto end = (offset_ / page) * page;
+
+    if (end < (released_ + ReleaseInterval)) { return; }
+
+    ::madvise(
+        static_cast<char*>(map_) + released_, end - released_, MADV_DONTNEED);
+    released_ = end;
+}
+
+auto Program::seek(const std::size_t offset, const std::size_t line) noexcept
+    -> void
+{
+    offset_ = std::min(offset, text_.size());
+    line_ = line;
+
+    if (offset_ < released_) {
+        const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        released_ = (offset_ / page) * page;
+    }
+}
+
+Program::~Program()
+{
+    if (nullptr != map_) { ::munmap(map_, map_size_); }
+}
+}  // namespace libsubtractive::gcode
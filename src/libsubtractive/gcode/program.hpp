@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "libsubtractive/communication/zmq/zeromq_wrapper.hpp"
+
+namespace libsubtractive::gcode
+{
+// Read-only G-code program which is either memory-mapped from a file or held
+// in a zmq frame. Lines are returned as views into the program text so
+// reading a program never copies it and memory use does not depend on the
+// program size.
+class Program
+{
+public:
+    static auto Buffer(zmq::Frame&& text) noexcept -> std::unique_ptr<Program>;
+    static auto Map(const std::string& path) noexcept
+        -> std::unique_ptr<Program>;
+
+    // Path, device, inode, size and modification time of a mapped file, which
+    // recognize it again without reading it. Empty for a buffered program.
+    auto identity() const noexcept -> std::string_view { return identity_; }
+    // Number of lines returned by next(), which is also the 1-based line
+    // number of the most recently returned line
+    auto line() const noexcept -> std::size_t { return line_; }
+    auto offset() const noexcept -> std::size_t { return offset_; }
+    auto size() const noexcept -> std::size_t { return text_.size(); }
+    auto text() const noexcept -> std::string_view { return text_; }
+
+    // Returns the next line without its line terminator. Returns false at the
+    // end of the program.
+    auto next(std::string_view& line) noexcept -> bool;
+    auto seek(const std::size_t offset, const std::size_t line) noexcept
+        -> void;
+
+    ~Program();
+
+private:
+    std::optional<zmq::Frame> frame_;
+    void* map_;
+    std::size_t map_size_;
+    std::string_view text_;
+    const std::string identity_;
+    std::size_t offset_;
+    std::size_t line_;
+    std::size_t released_;
+
+    auto release() noexcept -> void;
+
+    Program(
+        std::optional<zmq::Frame>&& frame,
+        void* map,
+        const std::size_t mapSize,
+        const std::string_view text,
+        std::string&& identity) noexcept;
+    Program() = delete;
+    Program(const Program&) = delete;
+    Program(Program&&) = delete;
+    auto operator=(const Program&) -> Program& = delete;
+    auto operator=(Program&&) -> Program& = delete;
+};
+}  // namespace libsubtractive::gcode
@@ -0,0 +1,469 @@
+#include "libsubtractive/gcode/resume.hpp"  // IWYU pragma: associated
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "libsubtractive/gcode/format.hpp"
+
+namespace libsubtractive::gcode
+{
+namespace
+{
+constexpr auto MillimetresPerInch = 25.4;
+// Digits after the decimal point of generated coordinates
+constexpr auto OutputPrecision = int{4};
+// Saved checkpoints are the byte offset followed by the modal state
+constexpr auto CheckpointSize = sizeof(std::uint64_t) + sizeof(Modal);
+
+static_assert(std::is_trivially_copyable_v<Modal>);
+
+// G and M codes are keyed by ten times their value so G38.2 is 382
+auto code(const double value) noexcept -> int;
+auto code(const double value) noexcept -> int
+{
+    return static_cast<int>(std::lround(value * 10.0));
+}
+
+auto append_code(const char letter, const int value, std::string& out) noexcept
+    -> void;
+auto append_code(const char letter, const int value, std::string& out) noexcept
+    -> void
+{
+    out.push_back(letter);
+    out.append(std::to_string(value / 10));
+
+    if (0 != (value % 10)) {
+        out.push_back('.');
+        out.append(std::to_string(value % 10));
+    }
+}
+
+auto append_word(const char letter, const double value, std::string& out)
+    noexcept -> void;
+auto append_word(const char letter, const double value, std::string& out)
+    noexcept -> void
+{
+    out.push_back(letter);
+
+    if (false == append_decimal(value, OutputPrecision, out)) {
+        out.push_back('0');
+    }
+}
+
+// Splits text at the next line terminator the same way Program::next does
+auto next_line(
+    const std::string_view text,
+    std::size_t& offset,
+    std::string_view& line) noexcept -> bool;
+auto next_line(
+    const std::string_view text,
+    std::size_t& offset,
+    std::string_view& line) noexcept -> bool
+{
+    if (offset >= text.size()) { return false; }
+
+    const auto* begin = text.data() + offset;
+    const auto remaining = text.size() - offset;
+    const auto* eol =
+        static_cast<const char*>(std::memchr(begin, '\n', remaining));
+    const auto length = (nullptr == eol)
+                            ? remaining
+                            : static_cast<std::size_t>(eol - begin);
+    offset += (nullptr == eol) ? length : length + 1u;
+    line = {begin, length};
+
+    if ((0 < line.size()) && ('\r' == line.back())) { line.remove_suffix(1); }
+
+    return true;
+}
+}  // namespace
+
+Modal::Modal() noexcept
+    : motion_(0)
+    , plane_(170)
+    , distance_(900)
+    , feed_mode_(940)
+    , units_(210)
+    , system_(540)
+    , position_()
+    , known_()
+    , safe_(0.0)
+    , safe_known_(false)
+    , feed_(0.0)
+    , spindle_(0.0)
+    , spindle_mode_(50)
+    , mist_(false)
+    , flood_(false)
+    , tool_(-1)
+{
+}
+
+auto Modal::operator()(const std::vector<Word>& words) noexcept -> void
+{
+    // Non-modal G code of the block, if any
+    auto command = int{-1};
+    auto motion = motion_;
+    auto axes = std::array<bool, 3>{};
+    auto values = Vector{};
+    auto feed = std::optional<double>{};
+    auto end{false};
+
+    for (const auto& word : words) {
+        switch (word.letter_) {
+            case 'G': {
+                const auto value = code(word.value_);
+
+                switch (value) {
+                    case 0:
+                    case 10:
+                    case 20:
+                    case 30:
+                    case 382:
+                    case 383:
+                    case 384:
+                    case 385:
+                    case 800: {
+                        motion = value;
+                    } break;
+                    case 170:
+                    case 180:
+                    case 190: {
+                        plane_ = value;
+                    } break;
+                    case 900:
+                    case 910: {
+                        distance_ = value;
+                    } break;
+                    case 930:
+                    case 940: {
+                        feed_mode_ = value;
+                    } break;
+                    case 200:
+                    case 210: {
+                        units_ = value;
+                    } break;
+                    case 540:
+                    case 550:
+                    case 560:
+                    case 570:
+                    case 580:
+                    case 590: {
+                        if (value != system_) { known_ = {}; }
+
+                        system_ = value;
+                    } break;
+                    default: {
+                        command = value;
+                    }
+                }
+            } break;
+            case 'M': {
+                switch (code(word.value_)) {
+                    case 20:
+                    case 300: {
+                        end = true;
+                    } break;
+                    case 30: {
+                        spindle_mode_ = 30;
+                    } break;
+                    case 40: {
+                        spindle_mode_ = 40;
+                    } break;
+                    case 50: {
+                        spindle_mode_ = 50;
+                    } break;
+                    case 70: {
+                        mist_ = true;
+                    } break;
+                    case 80: {
+                        flood_ = true;
+                    } break;
+                    case 90: {
+                        mist_ = false;
+                        flood_ = false;
+                    } break;
+                    default: {
+                    }
+                }
+            } break;
+            case 'X':
+            case 'Y':
+            case 'Z': {
+                const auto axis = static_cast<std::size_t>(word.letter_ - 'X');
+                axes.at(axis) = true;
+                values.at(axis) = word.value_;
+            } break;
+            case 'F': {
+                feed = word.value_;
+            } break;
+            case 'S': {
+                spindle_ = word.value_;
+            } break;
+            case 'T': {
+                tool_ = std::lround(word.value_);
+            } break;
+            default: {
+            }
+        }
+    }
+
+    const auto scale = (200 == units_) ? MillimetresPerInch : 1.0;
+
+    // NOTE in inverse time mode F is the reciprocal of the duration and is
+    // not converted
+    if (feed.has_value()) {
+        feed_ = (930 == feed_mode_) ? *feed : (*feed * scale);
+    }
+
+    motion_ = motion;
+
+    switch (command) {
+        case 40:
+        case 100:
+        case 281:
+        case 301:
+        case 921:
+        case 922:
+        case 923: {
+            // NOTE dwell, offsets and stored positions do not move the tool
+        } break;
+        case 280:
+        case 300: {
+            known_ = {};
+        } break;
+        case 530: {
+            for (auto i = std::size_t{0}; i < axes.size(); ++i) {
+                if (axes.at(i)) { known_.at(i) = false; }
+            }
+        } break;
+        case 920: {
+            for (auto i = std::size_t{0}; i < axes.size(); ++i) {
+                if (axes.at(i)) {
+                    position_.at(i) = values.at(i) * scale;
+                    known_.at(i) = true;
+                }
+            }
+        } break;
+        default: {
+            const auto probe = (382 <= motion_) && (385 >= motion_);
+
+            for (auto i = std::size_t{0}; i < axes.size(); ++i) {
+                if (false == axes.at(i)) { continue; }
+
+                if (probe) {
+                    known_.at(i) = false;
+                } else if (900 == distance_) {
+                    position_.at(i) = values.at(i) * scale;
+                    known_.at(i) = true;
+                } else {
+                    position_.at(i) += values.at(i) * scale;
+                }
+            }
+        }
+    }
+
+    if (known_.at(2)) {
+        const auto z = position_.at(2);
+        safe_ = safe_known_ ? std::max(safe_, z) : z;
+        safe_known_ = true;
+    }
+
+    // NOTE program end restores the same modes as Grbl
+    if (end) {
+        motion_ = 10;
+        plane_ = 170;
+        distance_ = 900;
+        feed_mode_ = 940;
+        system_ = 540;
+        spindle_mode_ = 50;
+        mist_ = false;
+        flood_ = false;
+    }
+}
+
+auto Modal::preamble(std::vector<std::string>& out) const noexcept -> void
+{
+    const auto scale = (200 == units_) ? MillimetresPerInch : 1.0;
+    const auto& [x, y, z] = known_;
+    auto line = std::string{};
+    append_code('G', units_, line);
+    append_code('G', plane_, line);
+    append_code('G', system_, line);
+    line.append("G90G94");
+    out.emplace_back(std::move(line));
+
+    if (0 <= tool_) {
+        line = "T";
+        line.append(std::to_string(tool_));
+        out.emplace_back(std::move(line));
+    }
+
+    if ((50 != spindle_mode_) || (0.0 < spindle_)) {
+        line.clear();
+        append_word('S', spindle_, line);
+
+        if (50 != spindle_mode_) { append_code('M', spindle_mode_, line); }
+
+        out.emplace_back(std::move(line));
+    }
+
+    if (mist_) { out.emplace_back("M7"); }
+
+    if (flood_) { out.emplace_back("M8"); }
+
+    const auto safe = std::max(safe_, position_.at(2));
+
+    if (z) {
+        line = "G0";
+        append_word('Z', safe / scale, line);
+        out.emplace_back(std::move(line));
+    }
+
+    if (x || y) {
+        line = "G0";
+
+        if (x) { append_word('X', position_.at(0) / scale, line); }
+
+        if (y) { append_word('Y', position_.at(1) / scale, line); }
+
+        out.emplace_back(std::move(line));
+    }
+
+    const auto feed = (940 == feed_mode_) && (0.0 < feed_);
+
+    if (z && (safe > position_.at(2))) {
+        line = feed ? "G1" : "G0";
+        append_word('Z', position_.at(2) / scale, line);
+
+        if (feed) { append_word('F', feed_ / scale, line); }
+
+        out.emplace_back(std::move(line));
+    }
+
+    line.clear();
+
+    if (910 == distance_) { line.append("G91"); }
+
+    if (930 == feed_mode_) { line.append("G93"); }
+
+    // NOTE a probe must not be repeated by axis words which follow it
+    if ((382 > motion_) || (385 < motion_)) {
+        append_code('G', motion_, line);
+    }
+
+    if (feed) { append_word('F', feed_ / scale, line); }
+
+    if (0 < line.size()) { out.emplace_back(std::move(line)); }
+}
+
+Resume::Resume(const Cache::Key& key) noexcept
+    : key_(key)
+    , lex_()
+    , checkpoints_(1)
+    , state_()
+    , lines_(0)
+{
+}
+
+auto Resume::advance(const std::size_t end) noexcept -> void
+{
+    ++lines_;
+
+    if (0u == (lines_ % Interval)) {
+        checkpoints_.emplace_back(Checkpoint{end, state_});
+    }
+}
+
+auto Resume::load(const std::string_view data) noexcept -> bool
+{
+    if ((0u == data.size()) || (0u != (data.size() % CheckpointSize))) {
+        return false;
+    }
+
+    auto checkpoints = std::vector<Checkpoint>{};
+    checkpoints.reserve(data.size() / CheckpointSize);
+
+    for (auto i = std::size_t{0}; i < data.size(); i += CheckpointSize) {
+        auto offset = std::uint64_t{};
+        auto& checkpoint = checkpoints.emplace_back();
+        std::memcpy(&offset, data.data() + i, sizeof(offset));
+        std::memcpy(
+            &checkpoint.state_,
+            data.data() + i + sizeof(offset),
+            sizeof(checkpoint.state_));
+        checkpoint.offset_ = static_cast<std::size_t>(offset);
+    }
+
+    if (0u != checkpoints.front().offset_) { return false; }
+
+    checkpoints_ = std::move(checkpoints);
+    state_ = checkpoints_.back().state_;
+    lines_ = (checkpoints_.size() - 1u) * Interval;
+
+    return true;
+}
+
+auto Resume::read(
+    const std::string_view line,
+    const std::size_t number,
+    const std::size_t end) noexcept -> void
+{
+    if ((lines_ + 1u) != number) { return; }
+
+    if (Lexer::Type::Block == lex_(line)) { state_(lex_.words()); }
+
+    advance(end);
+}
+
+auto Resume::save(std::string& out) const noexcept -> void
+{
+    out.reserve(out.size() + (checkpoints_.size() * CheckpointSize));
+
+    for (const auto& [offset, state] : checkpoints_) {
+        const auto value = static_cast<std::uint64_t>(offset);
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        out.append(reinterpret_cast<const char*>(&state), sizeof(state));
+    }
+}
+
+auto Resume::seek(
+    const std::string_view text,
+    const std::size_t number,
+    std::size_t& offset,
+    std::vector<std::string>& preamble) noexcept -> bool
+{
+    if (0u == number) { return false; }
+
+    const auto index =
+        std::min((number - 1u) / Interval, checkpoints_.size() - 1u);
+    const auto& checkpoint = checkpoints_.at(index);
+    auto position = checkpoint.offset_;
+    auto state = checkpoint.state_;
+    auto line = std::string_view{};
+
+    for (auto i = index * Interval; (i + 1u) < number; ++i) {
+        if (false == next_line(text, position, line)) { return false; }
+
+        if (Lexer::Type::Block == lex_(line)) { state(lex_.words()); }
+
+        // NOTE lines between the last checkpoint and the requested line are
+        // indexed along the way
+        if (i == lines_) {
+            state_ = state;
+            advance(position);
+        }
+    }
+
+    if (position >= text.size()) { return false; }
+
+    offset = position;
+    state.preamble(preamble);
+
+    return true;
+}
+}  // namespace libsubtractive::gcode
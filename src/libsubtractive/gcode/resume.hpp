@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "libsubtractive/gcode/cache.hpp"
+#include "libsubtractive/gcode/lexer.hpp"
+
+namespace libsubtractive::gcode
+{
+// Modal state left by the blocks of a program: units, plane, distance mode,
+// feed rate mode, work coordinate system, motion mode, feed rate, spindle,
+// coolant, tool and the work position. Positions and feed rates are held in
+// millimetres so they survive a change of units.
+//
+// The position of an axis becomes unknown after a move in machine
+// coordinates, a probe, G28 or G30, or a change of coordinate system, until
+// the program moves the axis to an absolute position again.
+class Modal
+{
+public:
+    auto operator()(const std::vector<Word>& words) noexcept -> void;
+
+    // Appends blocks which bring a controller from its power-on state to this
+    // state: the modes, tool, spindle and coolant are set, the tool is raised
+    // to the highest Z the program has used, moved over the work position,
+    // lowered at the feed rate, and finally the distance, feed rate and
+    // motion modes are restored.
+    auto preamble(std::vector<std::string>& out) const noexcept -> void;
+
+    Modal() noexcept;
+
+private:
+    using Vector = std::array<double, 3>;
+
+    // G codes keyed by ten times their value so G38.2 is 382
+    int motion_;
+    int plane_;
+    int distance_;
+    int feed_mode_;
+    int units_;
+    int system_;
+    Vector position_;
+    std::array<bool, 3> known_;
+    double safe_;
+    bool safe_known_;
+    double feed_;
+    double spindle_;
+    int spindle_mode_;
+    bool mist_;
+    bool flood_;
+    long tool_;
+};
+
+// Sparse index of a program which allows streaming to resume part way through
+// it. The byte offset of every Interval-th line and the modal state before it
+// are recorded as lines are read, so resuming seeks to the nearest checkpoint
+// at or before the requested line and only interprets the lines after it.
+class Resume
+{
+public:
+    static constexpr auto Interval = std::size_t{1024};
+
+    auto key() const noexcept -> const Cache::Key& { return key_; }
+    // Appends the checkpoints in a form load() accepts from the same build
+    auto save(std::string& out) const noexcept -> void;
+
+    // Replaces the checkpoints with ones saved from an index of the same
+    // program. Returns false and leaves the index unchanged if data is not
+    // valid.
+    auto load(const std::string_view data) noexcept -> bool;
+
+    // Call with each program line in order. Number is the 1-based line number
+    // and end the offset just past the line terminator. Lines which were
+    // already indexed are ignored.
+    auto read(
+        const std::string_view line,
+        const std::size_t number,
+        const std::size_t end) noexcept -> void;
+    // Finds the offset of the 1-based line number in text and the blocks
+    // which restore the modal state before it. Returns false if the program
+    // has fewer lines.
+    auto seek(
+        const std::string_view text,
+        const std::size_t number,
+        std::size_t& offset,
+        std::vector<std::string>& preamble) noexcept -> bool;
+
+    // Key identifies the program text
+    Resume(const Cache::Key& key) noexcept;
+
+private:
+    struct Checkpoint {
+        std::size_t offset_{};
+        Modal state_{};
+    };
+
+    Cache::Key key_;
+    Lexer lex_;
+    // Checkpoint i describes the program before line i * Interval + 1
+    std::vector<Checkpoint> checkpoints_;
+    Modal state_;
+    // Number of lines applied to state_
+    std::size_t lines_;
+
+    auto advance(const std::size_t end) noexcept -> void;
+};
+}  // namespace libsubtractive::gcode
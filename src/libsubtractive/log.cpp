@@ -0,0 +1,337 @@
+#include "libsubtractive/log.hpp"  // IWYU pragma: associated
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace libsubtractive
+{
+namespace log
+{
+std::atomic<Level> level_{Level::Info};
+
+// Records logged while this many are waiting to be written are dropped
+// rather than blocking the thread which logs them
+constexpr auto QueueSize = std::size_t{4096};
+constexpr auto FlushInterval = std::chrono::milliseconds{10};
+constexpr auto FlushTimeout = std::chrono::seconds{1};
+constexpr auto BinaryMagic = std::string_view{"LSLOG01\n"};
+
+auto prefix(const Level level) noexcept -> std::string_view;
+auto prefix(const Level level) noexcept -> std::string_view
+{
+    switch (level) {
+        case Level::Error: {
+            return "error: ";
+        }
+        case Level::Warning: {
+            return "warning: ";
+        }
+        case Level::Debug: {
+            return "debug: ";
+        }
+        case Level::Off:
+        case Level::Info:
+        default: {
+            return {};
+        }
+    }
+}
+
+// Small sequential numbers are easier to follow in a log than thread IDs
+auto thread_number() noexcept -> std::uint32_t;
+auto thread_number() noexcept -> std::uint32_t
+{
+    static auto next = std::atomic<std::uint32_t>{0};
+    thread_local const auto output = next++;
+
+    return output;
+}
+
+// Bounded queue with any number of producers and a single consumer. The
+// sequence number of each cell tells producers and the consumer whose turn it
+// is to use the cell, so neither side takes a lock.
+class Queue
+{
+public:
+    auto pop(Record& out) noexcept -> bool
+    {
+        auto& cell = cells_[tail_ & mask_];
+
+        if (cell.sequence_.load(std::memory_order_acquire) != tail_ + 1u) {
+            return false;
+        }
+
+        out = cell.record_;
+        cell.sequence_.store(tail_ + mask_ + 1u, std::memory_order_release);
+        ++tail_;
+
+        return true;
+    }
+    auto push(const Record& in) noexcept -> bool
+    {
+        auto head = head_.load(std::memory_order_relaxed);
+
+        while (true) {
+            auto& cell = cells_[head & mask_];
+            const auto sequence =
+                cell.sequence_.load(std::memory_order_acquire);
+
+            if (sequence == head) {
+                const auto claimed = head_.compare_exchange_weak(
+                    head, head + 1u, std::memory_order_relaxed);
+
+                if (claimed) {
+                    cell.record_ = in;
+                    cell.sequence_.store(head + 1u, std::memory_order_release);
+
+                    return true;
+                }
+            } else if (sequence < head) {
+                // NOTE the consumer has not yet emptied this cell
+                return false;
+            } else {
+                head = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Size must be a power of two
+    Queue(const std::size_t size)
+        : mask_(size - 1u)
+        , cells_(std::make_unique<Cell[]>(size))
+        , head_(0)
+        , tail_(0)
+    {
+        for (auto i = std::size_t{0}; i < size; ++i) {
+            cells_[i].sequence_.store(i, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence_;
+        Record record_;
+
+        Cell() noexcept
+            : sequence_(0)
+            , record_(Level::Off)
+        {
+        }
+    };
+
+    const std::size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<std::size_t> head_;
+    alignas(64) std::size_t tail_;
+
+    Queue() = delete;
+    Queue(const Queue&) = delete;
+    Queue(Queue&&) = delete;
+    auto operator=(const Queue&) -> Queue& = delete;
+    auto operator=(Queue&&) -> Queue& = delete;
+};
+
+// Owns the queue and the thread which empties it into the configured file, or
+// into standard error for errors and warnings and standard output otherwise
+class Logger
+{
+public:
+    static auto get() noexcept -> Logger&
+    {
+        static auto logger = Logger{};
+
+        return logger;
+    }
+
+    auto configure(const char* path) noexcept -> void
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        close();
+
+        if ((nullptr == path) || (0 == std::strlen(path))) { return; }
+
+        auto* file = std::fopen(path, "ab");
+
+        if (nullptr == file) {
+            std::fprintf(stderr, "Failed to open log file %s\n", path);
+
+            return;
+        }
+
+        std::fseek(file, 0, SEEK_END);
+
+        if (0 == std::ftell(file)) {
+            std::fwrite(BinaryMagic.data(), 1u, BinaryMagic.size(), file);
+        }
+
+        file_ = file;
+        binary_ = true;
+    }
+    auto flush() noexcept -> void
+    {
+        const auto target = submitted_.load();
+        const auto limit = std::chrono::steady_clock::now() + FlushTimeout;
+
+        while ((written_.load() < target) &&
+               (std::chrono::steady_clock::now() < limit)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+    }
+    auto submit(const Record& record) noexcept -> void
+    {
+        if (queue_.push(record)) {
+            ++submitted_;
+        } else {
+            ++dropped_;
+        }
+    }
+
+    ~Logger()
+    {
+        running_ = false;
+
+        if (thread_.joinable()) { thread_.join(); }
+
+        std::lock_guard<std::mutex> lock(lock_);
+        close();
+    }
+
+private:
+    Queue queue_;
+    std::atomic<std::uint64_t> submitted_;
+    std::atomic<std::uint64_t> written_;
+    std::atomic<std::uint64_t> dropped_;
+    std::mutex lock_;
+    std::FILE* file_;
+    bool binary_;
+    // Text of the records being written, reused to avoid allocations
+    std::string buffer_;
+    std::string errors_;
+    std::atomic_bool running_;
+    std::thread thread_;
+
+    Logger() noexcept
+        : queue_(QueueSize)
+        , submitted_(0)
+        , written_(0)
+        , dropped_(0)
+        , lock_()
+        , file_(stdout)
+        , binary_(false)
+        , buffer_()
+        , errors_()
+        , running_(true)
+        , thread_(&Logger::run, this)
+    {
+    }
+
+    auto close() noexcept -> void
+    {
+        if (stdout != file_) { std::fclose(file_); }
+
+        file_ = stdout;
+        binary_ = false;
+    }
+    auto flush(std::string& buffer, std::FILE* file) noexcept -> void
+    {
+        if (buffer.empty()) { return; }
+
+        std::fwrite(buffer.data(), 1u, buffer.size(), file);
+        std::fflush(file);
+        buffer.clear();
+    }
+    // Returns false if there was nothing to write
+    auto drain() noexcept -> bool
+    {
+        auto record = Record{Level::Off};
+        auto count = std::uint64_t{0};
+        std::lock_guard<std::mutex> lock(lock_);
+
+        if (const auto dropped = dropped_.exchange(0); 0 < dropped) {
+            record = Record{Level::Warning};
+            record.append("Dropped ");
+            record.append(dropped);
+            record.append(" log records");
+            write(record);
+        }
+
+        while (queue_.pop(record)) {
+            write(record);
+            ++count;
+        }
+
+        flush(buffer_, file_);
+        flush(errors_, stderr);
+
+        written_ += count;
+
+        return 0 < count;
+    }
+    auto run() noexcept -> void
+    {
+        while (running_) {
+            if (false == drain()) {
+                std::this_thread::sleep_for(FlushInterval);
+            }
+        }
+
+        drain();
+    }
+    auto write(const Record& record) noexcept -> void
+    {
+        const auto& header = record.header_;
+
+        if (binary_) {
+            buffer_.append(
+                reinterpret_cast<const char*>(&header), sizeof(header));
+            buffer_.append(record.text_.data(), header.size_);
+
+            return;
+        }
+
+        const auto error = (Level::Error == header.level_) ||
+                           (Level::Warning == header.level_);
+        auto& buffer = error ? errors_ : buffer_;
+        buffer.append(prefix(header.level_));
+        buffer.append(record.text_.data(), header.size_);
+        buffer.push_back('\n');
+    }
+
+    Logger(const Logger&) = delete;
+    Logger(Logger&&) = delete;
+    auto operator=(const Logger&) -> Logger& = delete;
+    auto operator=(Logger&&) -> Logger& = delete;
+};
+
+Record::Record(const Level level) noexcept
+    : header_{
+          static_cast<std::uint64_t>(
+              std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::system_clock::now().time_since_epoch())
+                  .count()),
+          thread_number(),
+          0,
+          level,
+          0}
+    , text_()
+{
+}
+
+auto configure(const Level level, const char* path) noexcept -> void
+{
+    level_.store(level);
+    Logger::get().configure(path);
+}
+
+auto flush() noexcept -> void { Logger::get().flush(); }
+
+auto submit(const Record& record) noexcept -> void
+{
+    Logger::get().submit(record);
+}
+}  // namespace log
+}  // namespace libsubtractive
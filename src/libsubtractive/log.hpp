@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#include "libsubtractive/libsubtractive.hpp"
+
+namespace libsubtractive
+{
+namespace log
+{
+enum class Level : std::uint8_t {
+    Off = LS_LOG_OFF,
+    Error = LS_LOG_ERROR,
+    Warning = LS_LOG_WARNING,
+    Info = LS_LOG_INFO,
+    Debug = LS_LOG_DEBUG,
+};
+
+// One log message. Records are formatted by the thread which logs them,
+// queued without locking and written out by a background thread.
+//
+// In the binary format each record is stored as its fixed size header
+// followed by size_ bytes of text, after an 8 byte "LSLOG01\n" file header.
+// Integers are in the byte order of the host.
+struct Record {
+    struct Header {
+        // Nanoseconds since the Unix epoch
+        std::uint64_t time_;
+        std::uint32_t thread_;
+        std::uint16_t size_;
+        Level level_;
+        std::uint8_t reserved_;
+    };
+
+    static constexpr auto Capacity = std::size_t{240};
+
+    Header header_;
+    // NOTE text beyond Capacity bytes is dropped
+    std::array<char, Capacity> text_;
+
+    auto append(const std::string_view in) noexcept -> void
+    {
+        const auto size = std::size_t{header_.size_};
+        const auto count = std::min(in.size(), Capacity - size);
+        std::memcpy(text_.data() + size, in.data(), count);
+        header_.size_ = static_cast<std::uint16_t>(size + count);
+    }
+    auto append(const char* in) noexcept -> void
+    {
+        append(std::string_view{(nullptr == in) ? "" : in});
+    }
+    auto append(const char in) noexcept -> void { append({&in, 1u}); }
+    template <
+        typename Number,
+        std::enable_if_t<std::is_arithmetic_v<Number>, int> = 0>
+    auto append(const Number in) noexcept -> void
+    {
+        auto* const begin = text_.data() + header_.size_;
+        auto* const end = text_.data() + Capacity;
+        const auto [next, error] = std::to_chars(begin, end, in);
+
+        if (std::errc{} == error) {
+            header_.size_ = static_cast<std::uint16_t>(next - text_.data());
+        }
+    }
+
+    Record(const Level level) noexcept;
+};
+
+// NOTE read on every call so a disabled level costs one relaxed load
+extern std::atomic<Level> level_;
+
+inline auto enabled(const Level level) noexcept -> bool
+{
+    return (Level::Off != level) &&
+           (level <= level_.load(std::memory_order_relaxed));
+}
+
+// Sets the level and where records are written. A null or empty path writes
+// text to standard output.
+auto configure(const Level level, const char* path) noexcept -> void;
+// Waits until every record logged before the call has been written
+auto flush() noexcept -> void;
+auto submit(const Record& record) noexcept -> void;
+
+template <typename... Args>
+auto write(const Level level, const Args&... args) noexcept -> void
+{
+    if (false == enabled(level)) { return; }
+
+    auto record = Record{level};
+    (record.append(args), ...);
+    submit(record);
+}
+
+template <typename... Args>
+auto error(const Args&... args) noexcept -> void
+{
+    write(Level::Error, args...);
+}
+template <typename... Args>
+auto warning(const Args&... args) noexcept -> void
+{
+    write(Level::Warning, args...);
+}
+template <typename... Args>
+auto info(const Args&... args) noexcept -> void
+{
+    write(Level::Info, args...);
+}
+template <typename... Args>
+auto debug(const Args&... args) noexcept -> void
+{
+    write(Level::Debug, args...);
+}
+}  // namespace log
+}  // namespace libsubtractive
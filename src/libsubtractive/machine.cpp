@@ -8,6 +8,7 @@
 #include <sstream>
 #include <tuple>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #include "libsubtractive/communication/zmq/zeromq_wrapper.hpp"
@@ -40,36 +41,82 @@ namespace libsubtractive
 {
 Machine::Machine(
     const zmq::Context& zeromq,
+    Reactor* reactor,
+    const LS_options& options,
     const std::string_view serial,
     const std::string_view endpoint,
     const bool enableSerialPort,
     const std::string serialEndpoint,
     const std::string flowEndpoint)
+    : Machine(
+          zeromq,
+          reactor,
+          options,
+          serial,
+          endpoint,
+          enableSerialPort,
+          make_links(options, enableSerialPort, serialEndpoint, flowEndpoint))
+{
+}
+
+Machine::Machine(
+    const zmq::Context& zeromq,
+    Reactor* reactor,
+    const LS_options& options,
+    const std::string_view serial,
+    const std::string_view endpoint,
+    const bool enableSerialPort,
+    Links&& links)
     : Actor(
           zeromq,
           [&]() -> auto {
               auto output = Sockets{};
               output.emplace_back(
                   zeromq.Socket(ZMQ_PAIR, Direction::Connect, endpoint));
-              output.emplace_back(
-                  zeromq.Socket(ZMQ_PAIR, Direction::Bind, flowEndpoint));
+
+              if (const auto* flow =
+                      std::get_if<std::string>(&links.flow_control_)) {
+                  output.emplace_back(
+                      zeromq.Socket(ZMQ_PAIR, Direction::Bind, *flow));
+              }
 
               return output;
-          })
+          },
+          reactor,
+          take_pipes({&links.flow_control_}))
     , usb_address_(serial)
     , parent_socket_(sockets_.at(0))
-    , flow_control_socket_(sockets_.at(1))
+    , flow_control_socket_(
+          std::holds_alternative<Pipe>(links.flow_control_)
+              ? Channel{pipes_.front()}
+              : Channel{sockets_.at(1)})
     , type_(MachineType::Unknown)
     , version_()
     , state_(State::Disconnected)
-    , flow_control_(zeromq_, usb_address_, serialEndpoint, flowEndpoint)
-    , connection_(zeromq_, serialEndpoint, enableSerialPort)
+    , flow_control_(
+          zeromq_,
+          reactor,
+          options,
+          usb_address_,
+          std::move(links.serial_),
+          std::move(links.parent_))
+    , connection_(
+          zeromq_, reactor, std::move(links.port_), enableSerialPort)
     , grbl_version_()
     , message_id_(-1)
+    , limits_()
 {
     init_actor();
 }
 
+// Attaches the motion limits of this machine so the context can pass the
+// request on to the analyzer
+auto Machine::command_analyze_program(zmq::Message&& in) noexcept -> void
+{
+    in.emplace_back(limits_);
+    parent_socket_.send(std::move(in));
+}
+
 auto Machine::command_init_grbl(zmq::Message&& in) noexcept -> void
 {
     if (4 > in.arg_count()) { abort(); }
@@ -169,6 +216,34 @@ auto Machine::forward_grbl(zmq::Message&& in) noexcept -> void
     flow_control_socket_.send(std::move(in));
 }
 
+// NOTE a serial port provided by the caller is reached through its endpoint
+// so only links between the actors of this machine become pipes
+auto Machine::make_links(
+    const LS_options& options,
+    const bool enableSerialPort,
+    const std::string& serialEndpoint,
+    const std::string& flowEndpoint) -> Links
+{
+    auto output = Links{
+        flowEndpoint, flowEndpoint, serialEndpoint, serialEndpoint};
+
+    if (false == options.ring_transport_) { return output; }
+
+    {
+        auto [machine, flow] = Pipe::Pair();
+        output.flow_control_ = std::move(machine);
+        output.parent_ = std::move(flow);
+    }
+
+    if (enableSerialPort) {
+        auto [flow, port] = Pipe::Pair();
+        output.serial_ = std::move(flow);
+        output.port_ = std::move(port);
+    }
+
+    return output;
+}
+
 auto Machine::process_command(zmq::Message&& command) noexcept -> bool
 {
     auto disconnectAfter{false};
@@ -180,9 +255,18 @@ auto Machine::process_command(zmq::Message&& command) noexcept -> bool
         case Command::InitGrbl: {
             command_init_grbl(std::move(command));
         } break;
-        case Command::SendGcode: {
+        case Command::SendGcode:
+        case Command::ExecuteProgram:
+        case Command::ResumeProgram: {
             forward_grbl(std::move(command));
         } break;
+        case Command::AnalyzeProgram: {
+            command_analyze_program(std::move(command));
+        } break;
+        case Command::StatusReport:
+        case Command::ProgramProgress: {
+            parent_socket_.send(std::move(command));
+        } break;
         case Command::USBDeviceAdded: {
             command_usb_device_added(std::move(command));
         } break;
@@ -216,8 +300,10 @@ auto Machine::process_command(zmq::Message&& command) noexcept -> bool
         case Command::Invalid:
         case Command::ListDevices:
         case Command::Subscribe:
+        case Command::SubscribeEvents:
         case Command::Unsubscribe:
-        case Command::ExecuteProgram:
+        case Command::EventsDropped:
+        case Command::ProgramAnalysis:
         case Command::PushDeviceRemoved:
         case Command::PushDeviceAdded:
         case Command::ListDevicesReply:
@@ -237,10 +323,15 @@ auto Machine::process_response(zmq::Message&& response) -> void
     if (3 > response.arg_count()) { abort(); }
 
     switch (response.arg(1).as<Command>()) {
+        case Command::GrblSettings: {
+            read_settings(response);
+            parent_socket_.send(std::move(response));
+        } break;
         case Command::SendGcode:
+        case Command::ExecuteProgram:
+        case Command::ResumeProgram:
         case Command::GrblHelp:
         case Command::GrblStatus:
-        case Command::GrblSettings:
         case Command::GrblVersion:
         case Command::GrblHome:
         case Command::GrblParams:
@@ -257,8 +348,13 @@ auto Machine::process_response(zmq::Message&& response) -> void
         case Command::Invalid:
         case Command::ListDevices:
         case Command::Subscribe:
+        case Command::SubscribeEvents:
         case Command::Unsubscribe:
-        case Command::ExecuteProgram:
+        case Command::AnalyzeProgram:
+        case Command::EventsDropped:
+        case Command::ProgramAnalysis:
+        case Command::StatusReport:
+        case Command::ProgramProgress:
         case Command::PushDeviceRemoved:
         case Command::PushDeviceAdded:
         case Command::ListDevicesReply:
@@ -302,10 +398,30 @@ auto Machine::process_response_version(zmq::Message&& response) -> void
         auto message = zeromq_.Command(Command::DeviceIsSupported);
         message.emplace_back(usb_address_.data(), usb_address_.size());
         parent_socket_.send(std::move(message));
+
+        // NOTE the motion limits are needed by LS_ANALYZE_PROGRAM
+        constexpr auto command{Command::GrblSettings};
+        auto settings = zeromq_.Command(command);
+        settings.emplace_back();
+        const auto& text = commands_.at(command);
+        settings.emplace_back(text.data(), text.size());
+        forward_grbl(std::move(settings));
     }
 
     state_ = State::Identified;
 }
 
+auto Machine::read_settings(const zmq::Message& response) noexcept -> void
+{
+    auto number = 0u;
+    auto value = 0.0;
+
+    for (auto i = std::size_t{3}; i < response.arg_count(); ++i) {
+        if (grbl::parse_setting(response.arg(i).str(), number, value)) {
+            limits_.set(number, value);
+        }
+    }
+}
+
 Machine::~Machine() { shutdown_actor(); }
 }  // namespace libsubtractive
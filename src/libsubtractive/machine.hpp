@@ -5,9 +5,11 @@
 #include <string_view>
 
 #include "libsubtractive/actor.hpp"
+#include "libsubtractive/communication/pipe.hpp"
 #include "libsubtractive/communication/flowcontrol.hpp"
 #include "libsubtractive/communication/serial/serial.hpp"
 #include "libsubtractive/communication/zmq/zeromq_wrapper.hpp"  // IWYU pragma: keep
+#include "libsubtractive/gcode/analyzer.hpp"
 
 namespace libsubtractive
 {
@@ -25,6 +27,8 @@ public:
 
     Machine(
         const zmq::Context& zeromq,
+        Reactor* reactor,
+        const LS_options& options,
         const std::string_view serial,
         const std::string_view endpoint,
         const bool enableSerialPort = true,
@@ -41,9 +45,18 @@ private:
         GhostGunner,
     };
 
+    // Both ends of the links between this machine, its flow control and its
+    // serial port
+    struct Links {
+        Endpoint flow_control_;
+        Endpoint parent_;
+        Endpoint serial_;
+        Endpoint port_;
+    };
+
     const std::string usb_address_;
     const zmq::Socket& parent_socket_;
-    const zmq::Socket& flow_control_socket_;
+    const Channel flow_control_socket_;
     MachineType type_;
     std::string version_;
     State state_;
@@ -51,9 +64,16 @@ private:
     SerialConnection connection_;
     grbl::VersionData grbl_version_;
     int message_id_;
+    gcode::Limits limits_;
 
     static auto init_sockets(const std::string_view parent) -> Sockets;
+    static auto make_links(
+        const LS_options& options,
+        const bool enableSerialPort,
+        const std::string& serialEndpoint,
+        const std::string& flowEndpoint) -> Links;
 
+    auto command_analyze_program(zmq::Message&& in) noexcept -> void;
     auto command_init_grbl(zmq::Message&& in) noexcept -> void;
     auto command_push_received(zmq::Message&& in) noexcept -> void;
     auto command_response_received(zmq::Message&& in) noexcept -> void;
@@ -63,7 +83,17 @@ private:
     auto process_command(zmq::Message&& command) noexcept -> bool;
     auto process_response(zmq::Message&& response) -> void;
     auto process_response_version(zmq::Message&& response) -> void;
+    auto read_settings(const zmq::Message& response) noexcept -> void;
 
     auto enable_flow_control() const noexcept -> void;
+
+    Machine(
+        const zmq::Context& zeromq,
+        Reactor* reactor,
+        const LS_options& options,
+        const std::string_view serial,
+        const std::string_view endpoint,
+        const bool enableSerialPort,
+        Links&& links);
 };
 }  // namespace libsubtractive
@@ -0,0 +1,97 @@
+#include "libsubtractive/outbox.hpp"  // IWYU pragma: associated
+
+#include <zmq.h>
+#include <algorithm>
+#include <cerrno>
+#include <utility>
+
+namespace libsubtractive
+{
+Outbox::Outbox(
+    const zmq::Message::Identity& subscriber,
+    Send send,
+    const std::size_t limit) noexcept
+    : subscriber_(subscriber)
+    , send_(std::move(send))
+    , limit_(std::max(limit, std::size_t{1}))
+    , ordered_()
+    , latest_()
+    , lost_(0)
+    , dropped_(0)
+{
+}
+
+auto Outbox::flush() noexcept -> State
+{
+    const auto deliver = [this](zmq::Message& message) -> State {
+        const auto error = send_(message);
+
+        if (0 == error) { return State::Empty; }
+
+        return (EAGAIN == error) ? State::Waiting : State::Unreachable;
+    };
+
+    while (true) {
+        notify();
+
+        if (ordered_.empty()) { break; }
+
+        if (const auto state = deliver(ordered_.front());
+            State::Empty != state) {
+            return state;
+        }
+
+        ordered_.pop_front();
+    }
+
+    for (auto i = latest_.begin(); i != latest_.end();) {
+        if (const auto state = deliver(i->second); State::Empty != state) {
+            return state;
+        }
+
+        i = latest_.erase(i);
+    }
+
+    return State::Empty;
+}
+
+// NOTE the notification takes the place of the lost messages, so it is queued
+// as soon as there is room and before any later message
+auto Outbox::notify() noexcept -> void
+{
+    if ((0 == lost_) || (ordered_.size() >= limit_)) { return; }
+
+    auto& message = ordered_.emplace_back(
+        zmq::Message::MakePush(subscriber_, Command::EventsDropped));
+    message.emplace_back(lost_);
+    lost_ = 0;
+}
+
+auto Outbox::send(zmq::Message&& message, const bool conflate) noexcept
+    -> State
+{
+    if (conflate && (0 < message.arg_count())) {
+        auto key = Key{message.type(), std::string{message.arg(0).str()}};
+        latest_.insert_or_assign(std::move(key), std::move(message));
+    } else {
+        // NOTE make room for message if the subscriber has caught up
+        if (false == ordered_.empty()) { flush(); }
+
+        notify();
+
+        if (ordered_.size() < limit_) {
+            ordered_.emplace_back(std::move(message));
+        } else {
+            ++lost_;
+            ++dropped_;
+        }
+    }
+
+    return flush();
+}
+
+auto Outbox::size() const noexcept -> std::size_t
+{
+    return ordered_.size() + latest_.size();
+}
+}  // namespace libsubtractive
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+
+#include "libsubtractive/communication/zmq/zeromq_wrapper.hpp"
+
+namespace libsubtractive
+{
+// Messages for one subscriber which it has not yet accepted. Responses and
+// pushes are delivered in order and discarded beyond a limit, in which case the
+// subscriber receives a Command::EventsDropped message holding the number of
+// discarded messages at the point where they were lost. Conflated messages
+// replace any undelivered message of the same type from the same machine, so
+// a subscriber which falls behind receives only the latest of each.
+class Outbox
+{
+public:
+    // Returns 0 if the message was sent, otherwise the zmq error which
+    // prevented it, in which case the message must be left intact
+    using Send = std::function<int(zmq::Message&)>;
+
+    enum class State : std::uint8_t {
+        Empty,
+        // The subscriber is not accepting messages
+        Waiting,
+        // The subscriber has gone away
+        Unreachable,
+    };
+
+    auto dropped() const noexcept -> std::uint64_t { return dropped_; }
+    auto size() const noexcept -> std::size_t;
+
+    // Sends queued messages until the subscriber stops accepting them
+    auto flush() noexcept -> State;
+    // Message must be addressed to the subscriber and carry the machine ID as
+    // its first argument if conflate is true
+    auto send(zmq::Message&& message, const bool conflate = false) noexcept
+        -> State;
+
+    Outbox(
+        const zmq::Message::Identity& subscriber,
+        Send send,
+        const std::size_t limit) noexcept;
+    Outbox(Outbox&&) = default;
+
+private:
+    using Key = std::pair<Command, std::string>;
+
+    const zmq::Message::Identity subscriber_;
+    const Send send_;
+    const std::size_t limit_;
+    std::deque<zmq::Message> ordered_;
+    std::map<Key, zmq::Message> latest_;
+    // Messages discarded since the last notification
+    std::uint64_t lost_;
+    std::uint64_t dropped_;
+
+    auto notify() noexcept -> void;
+
+    Outbox() = delete;
+    Outbox(const Outbox&) = delete;
+    auto operator=(const Outbox&) -> Outbox& = delete;
+    auto operator=(Outbox&&) -> Outbox& = delete;
+};
+}  // namespace libsubtractive
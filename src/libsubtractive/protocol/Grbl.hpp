@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <string_view>
 #include <tuple>
 
 namespace libsubtractive::grbl
@@ -7,4 +9,87 @@ namespace libsubtractive::grbl
 using VersionIndex = unsigned long;
 using Subversion = char;
 using VersionData = std::tuple<VersionIndex, VersionIndex, Subversion>;
+
+// Grbl acts on these bytes as soon as they arrive instead of placing them in
+// the serial receive buffer
+constexpr auto is_realtime(const char byte) noexcept -> bool
+{
+    switch (static_cast<unsigned char>(byte)) {
+        case 0x18:
+        case '?':
+        case '!':
+        case '~': {
+            return true;
+        }
+        default: {
+            return 0x80 <= static_cast<unsigned char>(byte);
+        }
+    }
+}
+
+// Grbl reads and writes numbers as an optional sign followed by digits and an
+// optional fraction. Parsing them directly avoids the locale handling and
+// allocation of the standard library conversions.
+inline auto parse_number(const std::string_view text, double& out) noexcept
+    -> bool
+{
+    auto it = text.begin();
+    const auto end = text.end();
+    const auto negative = (it != end) && ('-' == *it);
+
+    if (negative || ((it != end) && ('+' == *it))) { ++it; }
+
+    auto value = 0.0;
+    auto digits = std::size_t{0};
+
+    for (; (it != end) && ('0' <= *it) && ('9' >= *it); ++it, ++digits) {
+        value = (value * 10.0) + (*it - '0');
+    }
+
+    if ((it != end) && ('.' == *it)) {
+        auto scale = 0.1;
+
+        for (++it; (it != end) && ('0' <= *it) && ('9' >= *it);
+             ++it, ++digits) {
+            value += (*it - '0') * scale;
+            scale /= 10.0;
+        }
+    }
+
+    if ((0 == digits) || (it != end)) { return false; }
+
+    out = negative ? -value : value;
+
+    return true;
+}
+
+// Parses one "$<number>=<value>" line of the response to "$$"
+inline auto parse_setting(
+    const std::string_view line,
+    unsigned& number,
+    double& value) noexcept -> bool
+{
+    const auto equals = line.find('=');
+
+    if ((2 > equals) || (std::string_view::npos == equals) ||
+        ('$' != line.front())) {
+        return false;
+    }
+
+    auto parsed = 0u;
+
+    for (const auto c : line.substr(1, equals - 1u)) {
+        if (('0' > c) || ('9' < c)) { return false; }
+
+        parsed = (parsed * 10u) + static_cast<unsigned>(c - '0');
+    }
+
+    if (false == parse_number(line.substr(equals + 1u), value)) {
+        return false;
+    }
+
+    number = parsed;
+
+    return true;
+}
 }  // namespace libsubtractive::grbl
@@ -0,0 +1,216 @@
+#include "libsubtractive/protocol/Status.hpp"  // IWYU pragma: associated
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "libsubtractive/protocol/Grbl.hpp"
+
+namespace libsubtractive::grbl
+{
+namespace
+{
+using Axes = double[LS_MAX_AXES];
+
+constexpr auto Sticky = std::uint32_t{LS_STATUS_WCO | LS_STATUS_OVERRIDES};
+
+constexpr std::pair<std::string_view, LS_MachineState> States[] = {
+    {"Idle", LS_STATE_IDLE},
+    {"Run", LS_STATE_RUN},
+    {"Hold", LS_STATE_HOLD},
+    {"Jog", LS_STATE_JOG},
+    {"Alarm", LS_STATE_ALARM},
+    {"Door", LS_STATE_DOOR},
+    {"Check", LS_STATE_CHECK},
+    {"Home", LS_STATE_HOME},
+    {"Sleep", LS_STATE_SLEEP},
+    {"Tool", LS_STATE_TOOL},
+};
+
+constexpr auto Pins = std::string_view{"XYZABCPDHRS"};
+
+// Splits text at the first occurrence of delimiter. The returned token does
+// not include the delimiter and text is advanced past it.
+auto next_token(std::string_view& text, const char delimiter) noexcept
+    -> std::string_view
+{
+    const auto position = text.find(delimiter);
+    const auto output = text.substr(0, position);
+    text.remove_prefix(
+        (std::string_view::npos == position) ? text.size() : position + 1u);
+
+    return output;
+}
+
+auto parse_integer(const std::string_view text, std::uint32_t& out) noexcept
+    -> bool
+{
+    const auto* const end = text.data() + text.size();
+    const auto [last, error] = std::from_chars(text.data(), end, out);
+
+    return (std::errc{} == error) && (end == last);
+}
+
+auto parse_axes(std::string_view text, Axes& out, std::uint32_t& count) noexcept
+    -> bool
+{
+    auto axis = std::uint32_t{0};
+
+    while ((0 < text.size()) && (LS_MAX_AXES > axis)) {
+        if (false == parse_number(next_token(text, ','), out[axis])) {
+            return false;
+        }
+
+        ++axis;
+    }
+
+    count = axis;
+
+    return 0 < axis;
+}
+
+template <std::size_t N>
+auto parse_integers(std::string_view text, std::uint32_t* (&out)[N]) noexcept
+    -> bool
+{
+    for (auto* value : out) {
+        if (false == parse_integer(next_token(text, ','), *value)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+auto parse_pins(const std::string_view text, std::uint32_t& out) noexcept
+    -> void
+{
+    for (const auto c : text) {
+        const auto bit = Pins.find(c);
+
+        if (std::string_view::npos != bit) { out |= (1u << bit); }
+    }
+}
+
+auto parse_state(const std::string_view text, LS_status_report& out) noexcept
+    -> void
+{
+    // NOTE Grbl 0.9 separates fields with commas so only its state is decoded
+    const auto end = text.find_first_of(":,");
+    const auto name = text.substr(0, end);
+    out.state_ = LS_STATE_UNKNOWN;
+    out.substate_ = 0;
+
+    for (const auto& [label, state] : States) {
+        if (label == name) {
+            out.state_ = state;
+
+            break;
+        }
+    }
+
+    if ((std::string_view::npos != end) && (':' == text[end])) {
+        parse_integer(text.substr(end + 1u), out.substate_);
+    }
+}
+
+auto parse_field(
+    const std::string_view name,
+    const std::string_view value,
+    LS_status_report& out) noexcept -> void
+{
+    auto& fields = out.fields_;
+    auto axes = std::uint32_t{0};
+
+    if ("MPos" == name) {
+        if (parse_axes(value, out.machine_position_, axes)) {
+            out.axes_ = axes;
+            fields |= LS_STATUS_MPOS;
+        }
+    } else if ("WPos" == name) {
+        if (parse_axes(value, out.work_position_, axes)) {
+            out.axes_ = axes;
+            fields |= LS_STATUS_WPOS;
+        }
+    } else if ("WCO" == name) {
+        if (parse_axes(value, out.work_offset_, axes)) {
+            fields |= LS_STATUS_WCO;
+        }
+    } else if ("FS" == name) {
+        auto rest = value;
+
+        if (parse_number(next_token(rest, ','), out.feed_)) {
+            fields |= LS_STATUS_FEED;
+        }
+
+        if (parse_number(rest, out.spindle_)) { fields |= LS_STATUS_SPINDLE; }
+    } else if ("F" == name) {
+        if (parse_number(value, out.feed_)) { fields |= LS_STATUS_FEED; }
+    } else if ("Ov" == name) {
+        std::uint32_t* values[] = {
+            &out.override_feed_, &out.override_rapid_, &out.override_spindle_};
+
+        if (parse_integers(value, values)) { fields |= LS_STATUS_OVERRIDES; }
+    } else if ("Bf" == name) {
+        std::uint32_t* values[] = {
+            &out.planner_available_, &out.rx_available_};
+
+        if (parse_integers(value, values)) { fields |= LS_STATUS_BUFFER; }
+    } else if ("Pn" == name) {
+        parse_pins(value, out.pins_);
+        fields |= LS_STATUS_PINS;
+    } else if ("Ln" == name) {
+        if (parse_integer(value, out.line_)) { fields |= LS_STATUS_LINE; }
+    }
+}
+
+// Fills in whichever of MPos and WPos was not reported using WPos = MPos - WCO
+auto derive_positions(LS_status_report& out) noexcept -> void
+{
+    auto& fields = out.fields_;
+
+    if (0 == (fields & LS_STATUS_WCO)) { return; }
+
+    const auto machine = (0 != (fields & LS_STATUS_MPOS));
+    const auto work = (0 != (fields & LS_STATUS_WPOS));
+
+    if (machine == work) { return; }
+
+    for (auto i = std::uint32_t{0}; i < out.axes_; ++i) {
+        if (machine) {
+            out.work_position_[i] =
+                out.machine_position_[i] - out.work_offset_[i];
+        } else {
+            out.machine_position_[i] =
+                out.work_position_[i] + out.work_offset_[i];
+        }
+    }
+
+    fields |= (LS_STATUS_MPOS | LS_STATUS_WPOS);
+}
+}  // namespace
+
+auto parse_status(const std::string_view line, LS_status_report& out) noexcept
+    -> bool
+{
+    if ((2 > line.size()) || ('<' != line.front()) || ('>' != line.back())) {
+        return false;
+    }
+
+    auto text = line.substr(1, line.size() - 2u);
+    out.fields_ &= Sticky;
+    out.pins_ = 0;
+    parse_state(next_token(text, '|'), out);
+
+    while (0 < text.size()) {
+        auto value = next_token(text, '|');
+        const auto name = next_token(value, ':');
+        parse_field(name, value, out);
+    }
+
+    derive_positions(out);
+
+    return true;
+}
+}  // namespace libsubtractive::grbl
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string_view>
+
+#include "libsubtractive/libsubtractive.hpp"
+
+namespace libsubtractive::grbl
+{
+// Decodes a Grbl 1.1 real-time status report such as
+// <Run|MPos:1.000,2.000,3.000|FS:500,0|Ov:100,100,100> into out without
+// allocating. Work offset and override values from earlier reports are kept
+// since Grbl only sends them periodically. Unrecognized fields are ignored.
+// Returns false if line is not a status report.
+auto parse_status(const std::string_view line, LS_status_report& out) noexcept
+    -> bool;
+}  // namespace libsubtractive::grbl
@@ -0,0 +1,313 @@
+#include "libsubtractive/reactor.hpp"  // IWYU pragma: associated
+
+#include <boost/asio.hpp>
+#include <zmq.h>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "libsubtractive/communication/zmq/zeromq_wrapper.hpp"
+#include "libsubtractive/log.hpp"
+
+namespace libsubtractive
+{
+struct Reactor::IO {
+    boost::asio::io_context context_;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type>
+        work_;
+    std::thread thread_;
+
+    IO()
+        : context_()
+        , work_(boost::asio::make_work_guard(context_))
+        , thread_([this] { context_.run(); })
+    {
+    }
+
+    ~IO()
+    {
+        work_.reset();
+        context_.stop();
+
+        if (thread_.joinable()) { thread_.join(); }
+    }
+};
+
+struct Reactor::Thread {
+    enum class Operation : bool { Add = true, Remove = false };
+
+    auto add(Client& client) noexcept -> void
+    {
+        request(Operation::Add, client);
+    }
+    auto remove(Client& client) noexcept -> void
+    {
+        if (std::this_thread::get_id() == thread_.get_id()) {
+            // NOTE a client destroyed by another client on the same thread
+            std::replace(
+                clients_.begin(),
+                clients_.end(),
+                &client,
+                static_cast<Client*>(nullptr));
+            dirty_ = true;
+        } else {
+            request(Operation::Remove, client);
+        }
+    }
+
+    Thread(const zmq::Context& zeromq)
+        : endpoint_(RandomEndpoint())
+        , pull_(zeromq.Socket(ZMQ_PULL, Direction::Bind, endpoint_))
+        , push_(zeromq.Socket(ZMQ_PUSH, Direction::Connect, endpoint_))
+        , lock_()
+        , changed_()
+        , pending_()
+        , requested_(0)
+        , completed_(0)
+        , clients_()
+        , items_()
+        , counts_()
+        , dirty_(true)
+        , running_(true)
+        , thread_([this] { run(); })
+    {
+    }
+
+    ~Thread()
+    {
+        running_ = false;
+        wake();
+
+        if (thread_.joinable()) { thread_.join(); }
+    }
+
+private:
+    using Request = std::pair<Operation, Client*>;
+
+    const std::string endpoint_;
+    const zmq::Socket pull_;
+    const zmq::Socket push_;
+    std::mutex lock_;
+    std::condition_variable changed_;
+    std::vector<Request> pending_;
+    std::uint64_t requested_;
+    std::uint64_t completed_;
+    std::vector<Client*> clients_;
+    std::vector<zmq_pollitem_t> items_;
+    std::vector<std::size_t> counts_;
+    bool dirty_;
+    std::atomic_bool running_;
+    std::thread thread_;
+
+    auto dispatch() noexcept -> void
+    {
+        auto offset = std::size_t{1};
+
+        for (auto i = std::size_t{0}; i < clients_.size(); ++i) {
+            const auto count = counts_.at(i);
+            auto* client = clients_.at(i);
+
+            if (nullptr != client) {
+                auto& items = client->reactor_items();
+
+                assert(count <= items.size());
+
+                auto ready{false};
+
+                for (auto j = std::size_t{0}; j < count; ++j) {
+                    const auto revents = items_.at(offset + j).revents;
+                    items.at(j).revents = revents;
+                    ready |= (0 != revents);
+                }
+
+                if (ready) {
+                    if (client->reactor_dispatch()) {
+                        clients_.at(i) = nullptr;
+                        dirty_ = true;
+                    } else if (items.size() != count) {
+                        dirty_ = true;
+                    }
+                }
+            }
+
+            offset += count;
+        }
+    }
+    auto expire() noexcept -> void
+    {
+        const auto now = Clock::now();
+
+        // NOTE a timer may remove a client so clients_ must not be resized
+        for (auto i = std::size_t{0}; i < clients_.size(); ++i) {
+            auto* client = clients_.at(i);
+
+            if ((nullptr != client) && (client->reactor_deadline() <= now)) {
+                client->reactor_expire();
+            }
+        }
+    }
+    auto next_deadline() const noexcept -> Clock::time_point
+    {
+        auto output = Clock::time_point::max();
+
+        for (const auto* client : clients_) {
+            if (nullptr != client) {
+                output = std::min(output, client->reactor_deadline());
+            }
+        }
+
+        return output;
+    }
+    auto process_requests() noexcept -> void
+    {
+        while (0 <= zmq_recv(pull_, nullptr, 0, ZMQ_DONTWAIT)) { ; }
+
+        auto lock = std::unique_lock<std::mutex>{lock_};
+
+        for (const auto& [operation, client] : pending_) {
+            if (Operation::Add == operation) {
+                clients_.emplace_back(client);
+            } else {
+                clients_.erase(
+                    std::remove(clients_.begin(), clients_.end(), client),
+                    clients_.end());
+            }
+        }
+
+        pending_.clear();
+        completed_ = requested_;
+        dirty_ = true;
+        lock.unlock();
+        changed_.notify_all();
+    }
+    auto rebuild() noexcept -> void
+    {
+        clients_.erase(
+            std::remove(clients_.begin(), clients_.end(), nullptr),
+            clients_.end());
+        items_.clear();
+        counts_.clear();
+
+        {
+            auto& wake = items_.emplace_back();
+            wake.socket = pull_;
+            wake.events = ZMQ_POLLIN;
+        }
+
+        for (auto* client : clients_) {
+            const auto& items = client->reactor_items();
+            items_.insert(items_.end(), items.begin(), items.end());
+            counts_.emplace_back(items.size());
+        }
+
+        dirty_ = false;
+    }
+    auto request(const Operation operation, Client& client) noexcept -> void
+    {
+        auto lock = std::unique_lock<std::mutex>{lock_};
+        pending_.emplace_back(operation, &client);
+        const auto ticket = ++requested_;
+        wake();
+
+        if (Operation::Remove == operation) {
+            changed_.wait(lock, [&] { return completed_ >= ticket; });
+        }
+    }
+    auto run() noexcept -> void
+    {
+        while (running_) {
+            if (dirty_) { rebuild(); }
+
+            const auto events = zmq_poll(
+                items_.data(),
+                static_cast<int>(items_.size()),
+                poll_timeout(next_deadline()));
+
+            if (0 > events) {
+                const auto error = zmq_errno();
+                log::error(zmq_strerror(error));
+
+                continue;
+            }
+
+            if (ZMQ_POLLIN == items_.front().revents) {
+                // NOTE client list changed so the remaining revents can not be
+                // trusted. Any ready sockets will be reported again.
+                process_requests();
+
+                continue;
+            }
+
+            if (0 < events) { dispatch(); }
+
+            expire();
+        }
+    }
+    auto wake() const noexcept -> void
+    {
+        zmq_send(push_, nullptr, 0, ZMQ_DONTWAIT);
+    }
+
+    Thread() = delete;
+    Thread(const Thread&) = delete;
+    Thread(Thread&&) = delete;
+    auto operator=(const Thread&) -> Thread& = delete;
+    auto operator=(Thread&&) -> Thread& = delete;
+};
+
+Reactor::Reactor(const zmq::Context& zeromq, const std::size_t threads)
+    : threads_()
+    , io_(std::make_unique<IO>())
+    , lock_()
+    , owners_()
+    , next_(0)
+{
+    threads_.reserve(threads);
+
+    for (auto i = std::size_t{0}; i < std::max(threads, std::size_t{1}); ++i) {
+        threads_.emplace_back(std::make_unique<Thread>(zeromq));
+    }
+}
+
+auto Reactor::add(Client& client) noexcept -> void
+{
+    auto lock = std::lock_guard<std::mutex>{lock_};
+    auto& thread = *threads_.at(next_++ % threads_.size());
+    owners_[&client] = &thread;
+    thread.add(client);
+}
+
+auto Reactor::io_context() noexcept -> boost::asio::io_context&
+{
+    return io_->context_;
+}
+
+auto Reactor::remove(Client& client) noexcept -> void
+{
+    auto* thread = [&]() -> Thread* {
+        auto lock = std::lock_guard<std::mutex>{lock_};
+        auto it = owners_.find(&client);
+
+        if (owners_.end() == it) { return nullptr; }
+
+        auto* output = it->second;
+        owners_.erase(it);
+
+        return output;
+    }();
+
+    if (nullptr != thread) { thread->remove(client); }
+}
+
+Reactor::~Reactor()
+{
+    threads_.clear();
+    io_.reset();
+}
+}  // namespace libsubtractive
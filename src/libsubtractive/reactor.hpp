@@ -0,0 +1,95 @@
+#pragma once
+
+#include <zmq.h>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace boost
+{
+namespace asio
+{
+class io_context;
+}  // namespace asio
+}  // namespace boost
+
+namespace libsubtractive
+{
+namespace zmq
+{
+class Context;
+}  // namespace zmq
+}  // namespace libsubtractive
+
+namespace libsubtractive
+{
+// Fixed pool of threads which multiplex the sockets of many actors. Every
+// client is pinned to exactly one pool thread for its entire lifetime so its
+// messages are always processed sequentially and in order.
+class Reactor
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    class Client
+    {
+    public:
+        virtual ~Client() = default;
+
+    protected:
+        friend Reactor;
+
+        // Sockets to poll. The reactor writes revents into this vector before
+        // calling reactor_dispatch() and notices when it grows.
+        virtual auto reactor_items() noexcept
+            -> std::vector<zmq_pollitem_t>& = 0;
+        // Returns true when the client has shut down and must not be
+        // dispatched again.
+        virtual auto reactor_dispatch() noexcept -> bool = 0;
+        // Time at which reactor_expire() should be called, or
+        // Clock::time_point::max() if the client has no pending timer
+        virtual auto reactor_deadline() const noexcept -> Clock::time_point = 0;
+        virtual auto reactor_expire() noexcept -> void = 0;
+    };
+
+    // Converts a deadline into a zmq_poll timeout in milliseconds
+    static auto poll_timeout(const Clock::time_point deadline) noexcept -> long
+    {
+        if (Clock::time_point::max() == deadline) { return -1; }
+
+        const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(
+            deadline - Clock::now());
+
+        return std::max(static_cast<long>(remaining.count()), 0L);
+    }
+
+    auto add(Client& client) noexcept -> void;
+    auto io_context() noexcept -> boost::asio::io_context&;
+    auto remove(Client& client) noexcept -> void;
+    auto size() const noexcept -> std::size_t { return threads_.size(); }
+
+    Reactor(const zmq::Context& zeromq, const std::size_t threads);
+
+    ~Reactor();
+
+private:
+    struct Thread;
+    struct IO;
+
+    std::vector<std::unique_ptr<Thread>> threads_;
+    std::unique_ptr<IO> io_;
+    std::mutex lock_;
+    std::map<const Client*, Thread*> owners_;
+    std::size_t next_;
+
+    Reactor() = delete;
+    Reactor(const Reactor&) = delete;
+    Reactor(Reactor&&) = delete;
+    auto operator=(const Reactor&) -> Reactor& = delete;
+    auto operator=(Reactor&&) -> Reactor& = delete;
+};
+}  // namespace libsubtractive
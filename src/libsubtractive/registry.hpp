@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace libsubtractive
+{
+// Values addressed both by a string ID and by a small integer handle. Each ID
+// is stored once and looked up by string_view without allocating. Entries are
+// never removed, so handles, IDs and references to values remain valid for the
+// lifetime of the registry.
+template <typename Value>
+class Registry
+{
+public:
+    using Handle = std::uint32_t;
+
+    static constexpr auto Invalid = std::numeric_limits<Handle>::max();
+
+    // Returns Invalid if the ID has not been interned
+    auto find(const std::string_view id) const noexcept -> Handle
+    {
+        const auto it = index_.find(id);
+
+        return (index_.end() == it) ? Invalid : it->second;
+    }
+    auto get(const Handle handle) const noexcept -> const Value&
+    {
+        return slots_[handle]->value_;
+    }
+    auto id(const Handle handle) const noexcept -> std::string_view
+    {
+        return slots_[handle]->id_;
+    }
+    auto size() const noexcept -> std::size_t { return slots_.size(); }
+
+    auto get(const Handle handle) noexcept -> Value&
+    {
+        return slots_[handle]->value_;
+    }
+    // Returns the handle of the ID, adding a default constructed value if the
+    // ID is new. Only new IDs allocate.
+    auto intern(const std::string_view id) noexcept(false) -> Handle
+    {
+        if (const auto handle = find(id); Invalid != handle) { return handle; }
+
+        const auto handle = static_cast<Handle>(slots_.size());
+        const auto& slot =
+            slots_.emplace_back(std::make_unique<Slot>(std::string{id}));
+        // NOTE the key views the string owned by the slot, which never moves
+        index_.emplace(slot->id_, handle);
+
+        return handle;
+    }
+
+    Registry() noexcept
+        : slots_()
+        , index_()
+    {
+    }
+
+private:
+    struct Slot {
+        const std::string id_;
+        Value value_;
+
+        Slot(std::string&& id)
+            : id_(std::move(id))
+            , value_()
+        {
+        }
+    };
+
+    std::vector<std::unique_ptr<Slot>> slots_;
+    std::unordered_map<std::string_view, Handle> index_;
+
+    Registry(const Registry&) = delete;
+    Registry(Registry&&) = delete;
+    auto operator=(const Registry&) -> Registry& = delete;
+    auto operator=(Registry&&) -> Registry& = delete;
+};
+}  // namespace libsubtractive
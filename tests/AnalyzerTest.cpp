@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <string>
+
+#include "libsubtractive/gcode/analyzer.hpp"
+#include "libsubtractive/libsubtractive.hpp"
+
+namespace
+{
+constexpr auto Pi = 3.14159265358979323846;
+
+auto limits() -> libsubtractive::gcode::Limits
+{
+    auto output = libsubtractive::gcode::Limits{};
+    output.rate_ = {6000.0, 6000.0, 600.0};
+    output.acceleration_ = {100.0, 100.0, 50.0};
+
+    return output;
+}
+}  // namespace
+
+TEST(Analyzer, reads_limits_from_settings)
+{
+    auto limits = libsubtractive::gcode::Limits{};
+
+    EXPECT_TRUE(limits.set(111, 2000.0));
+    EXPECT_TRUE(limits.set(122, 25.0));
+    EXPECT_FALSE(limits.set(113, 1.0));
+    EXPECT_FALSE(limits.set(120, 0.0));
+    EXPECT_DOUBLE_EQ(limits.rate_.at(1), 2000.0);
+    EXPECT_DOUBLE_EQ(limits.acceleration_.at(2), 25.0);
+    EXPECT_DOUBLE_EQ(limits.acceleration_.at(0), 10.0);
+}
+
+TEST(Analyzer, measures_moves)
+{
+    const auto analyze = libsubtractive::gcode::Analyzer{limits(), 2};
+    const auto result = analyze(
+        "G21 G90 G17\n"
+        "$H\n"
+        "G0 X10 Y0 Z5 ; rapid\n"
+        "G1 Z0 F300\n"
+        "G1 X20 F600\n"
+        "G2 X30 Y0 I5 J0\n"
+        "M30\n");
+
+    EXPECT_EQ(result.state_, LS_PROGRAM_COMPLETE);
+    EXPECT_EQ(result.lines_, 7u);
+    EXPECT_EQ(result.skipped_, 1u);
+    EXPECT_EQ(result.moves_, 4u);
+    EXPECT_EQ(result.arcs_, 1u);
+    EXPECT_NEAR(result.rapid_distance_, std::hypot(10.0, 5.0), 1e-9);
+    EXPECT_NEAR(result.feed_distance_, 5.0 + 10.0 + (5.0 * Pi), 1e-9);
+    EXPECT_DOUBLE_EQ(result.min_[0], 0.0);
+    EXPECT_DOUBLE_EQ(result.max_[0], 30.0);
+    EXPECT_NEAR(result.min_[1], 0.0, 1e-9);
+    EXPECT_NEAR(result.max_[1], 5.0, 1e-9);
+    EXPECT_DOUBLE_EQ(result.max_[2], 5.0);
+    EXPECT_DOUBLE_EQ(result.feed_min_, 300.0);
+    EXPECT_DOUBLE_EQ(result.feed_max_, 600.0);
+
+    // NOTE feed moves alone take at least distance / feed rate
+    const auto minimum = (5.0 / 5.0) + ((10.0 + (5.0 * Pi)) / 10.0);
+    EXPECT_GT(result.duration_, minimum);
+    EXPECT_LT(result.duration_, minimum + 2.0);
+}
+
+TEST(Analyzer, converts_inches_and_incremental_moves)
+{
+    const auto analyze = libsubtractive::gcode::Analyzer{limits(), 1};
+    const auto result = analyze("G20 G91\nG1 X1 F10\nX1\nG90 G21 X0\n");
+
+    EXPECT_EQ(result.moves_, 3u);
+    EXPECT_NEAR(result.feed_distance_, 4.0 * 25.4, 1e-9);
+    EXPECT_NEAR(result.max_[0], 2.0 * 25.4, 1e-9);
+    EXPECT_NEAR(result.feed_max_, 254.0, 1e-9);
+}
+
+TEST(Analyzer, matches_across_thread_counts)
+{
+    auto program = std::string{"G21 G90\n"};
+
+    for (auto i = 0; i < 200000; ++i) {
+        program.append("G1 X" + std::to_string(i % 100) + " Y" +
+                       std::to_string((i / 100) % 50) + " F" +
+                       std::to_string(1000 + (i % 7) * 100) + "\n");
+    }
+
+    const auto one = libsubtractive::gcode::Analyzer{limits(), 1}(program);
+    const auto four = libsubtractive::gcode::Analyzer{limits(), 4}(program);
+
+    EXPECT_EQ(one.lines_, 200001u);
+    EXPECT_EQ(one.lines_, four.lines_);
+    EXPECT_EQ(one.moves_, four.moves_);
+    EXPECT_DOUBLE_EQ(one.duration_, four.duration_);
+    EXPECT_DOUBLE_EQ(one.feed_distance_, four.feed_distance_);
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "libsubtractive/gcode/cache.hpp"
+
+namespace
+{
+using Cache = libsubtractive::gcode::Cache;
+
+class CacheTest : public testing::Test
+{
+protected:
+    std::string directory_{};
+
+    auto entries() const -> std::size_t
+    {
+        auto output = std::size_t{0};
+        auto* directory = ::opendir(directory_.c_str());
+
+        while (const auto* file = ::readdir(directory)) {
+            if ('.' != file->d_name[0]) { ++output; }
+        }
+
+        ::closedir(directory);
+
+        return output;
+    }
+
+    auto store(Cache& cache, const Cache::Key& key, const std::string& line)
+        -> bool
+    {
+        auto writer = cache.record(key);
+
+        if (false == bool(writer)) { return false; }
+
+        writer->add(line, 0, 1);
+
+        return cache.commit(std::move(writer), 0, 1, line.size());
+    }
+
+    auto SetUp() -> void override
+    {
+        auto path = std::string{"/tmp/ls-cache-XXXXXX"};
+        ASSERT_NE(nullptr, ::mkdtemp(path.data()));
+        directory_ = path;
+    }
+
+    auto TearDown() -> void override
+    {
+        auto* directory = ::opendir(directory_.c_str());
+
+        while (const auto* file = ::readdir(directory)) {
+            const auto name = std::string{file->d_name};
+
+            if (("." != name) && (".." != name)) {
+                ::unlink((directory_ + '/' + name).c_str());
+            }
+        }
+
+        ::closedir(directory);
+        ::rmdir(directory_.c_str());
+    }
+};
+}  // namespace
+
+TEST_F(CacheTest, hash_depends_on_settings)
+{
+    const auto program = std::string_view{"G0X1\nG1X2F100\n"};
+
+    EXPECT_EQ(Cache::Hash(program, "a"), Cache::Hash(program, "a"));
+    EXPECT_NE(Cache::Hash(program, "a"), Cache::Hash(program, "b"));
+    EXPECT_NE(Cache::Hash(program, "a"), Cache::Hash("G0X1\nG1X2F101\n", "a"));
+}
+
+TEST_F(CacheTest, round_trip)
+{
+    auto cache = Cache{directory_, 0};
+    const auto key = Cache::Hash("program", "settings");
+
+    EXPECT_FALSE(cache.find(key));
+
+    auto writer = cache.record(key);
+    ASSERT_TRUE(writer);
+    writer->add("G0X1\n", 10, 2);
+    writer->add("G1X2F100\n", 25, 4);
+    writer->add("M2\n", 31, 5);
+    EXPECT_EQ(entries(), 0u);
+    ASSERT_TRUE(cache.commit(std::move(writer), 3, 6, 40));
+    EXPECT_EQ(entries(), 1u);
+
+    const auto reader = cache.find(key);
+    ASSERT_TRUE(reader);
+    ASSERT_EQ(reader->count(), 3u);
+    EXPECT_EQ(reader->errors(), 3u);
+    EXPECT_EQ(reader->source_lines(), 6u);
+    EXPECT_EQ(reader->source_size(), 40u);
+    EXPECT_EQ(reader->line(0), "G0X1\n");
+    EXPECT_EQ(reader->line(1), "G1X2F100\n");
+    EXPECT_EQ(reader->line(2), "M2\n");
+    EXPECT_EQ(reader->line(3), "");
+    EXPECT_EQ(reader->entry(1).source_offset_, 25u);
+    EXPECT_EQ(reader->entry(1).source_line_, 4u);
+    EXPECT_FALSE(cache.find(Cache::Hash("program", "other")));
+}
+
+TEST_F(CacheTest, checkpoints)
+{
+    auto cache = Cache{directory_, 0};
+    const auto key = Cache::Hash("program", "settings");
+    const auto checkpoints = std::string{"saved\0state", 11};
+    auto writer = cache.record(key);
+    ASSERT_TRUE(writer);
+    writer->add("G0X1\n", 10, 2);
+    ASSERT_TRUE(cache.commit(std::move(writer), 0, 2, 10, checkpoints));
+
+    const auto reader = cache.find(key);
+    ASSERT_TRUE(reader);
+    EXPECT_EQ(reader->line(0), "G0X1\n");
+    EXPECT_EQ(reader->checkpoints(), checkpoints);
+}
+
+TEST_F(CacheTest, abandoned_entry)
+{
+    auto cache = Cache{directory_, 0};
+    const auto key = Cache::Hash("program", "settings");
+
+    {
+        auto writer = cache.record(key);
+        ASSERT_TRUE(writer);
+        writer->add("G0X1\n", 5, 1);
+    }
+
+    EXPECT_EQ(entries(), 0u);
+    EXPECT_FALSE(cache.find(key));
+}
+
+TEST_F(CacheTest, evict_least_recently_used)
+{
+    const auto line = std::string(1000, 'X') + '\n';
+    auto cache = Cache{directory_, 2500};
+    const auto first = Cache::Hash("first", "");
+    const auto second = Cache::Hash("second", "");
+    const auto third = Cache::Hash("third", "");
+
+    ASSERT_TRUE(store(cache, first, line));
+    ::usleep(20000);
+    ASSERT_TRUE(store(cache, second, line));
+    ::usleep(20000);
+    // NOTE using the first entry makes the second one the oldest
+    ASSERT_TRUE(cache.find(first));
+    ::usleep(20000);
+    ASSERT_TRUE(store(cache, third, line));
+
+    EXPECT_EQ(entries(), 2u);
+    EXPECT_TRUE(cache.find(first));
+    EXPECT_FALSE(cache.find(second));
+    EXPECT_TRUE(cache.find(third));
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
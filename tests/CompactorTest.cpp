@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+
+#include "libsubtractive/gcode/compactor.hpp"
+
+namespace
+{
+auto compact(
+    libsubtractive::gcode::Compactor& compactor,
+    const std::string_view line) -> std::string
+{
+    auto output = std::string{};
+    compactor(line, output);
+
+    return output;
+}
+}  // namespace
+
+TEST(Compactor, removes_comments_whitespace_and_zeros)
+{
+    auto compactor = libsubtractive::gcode::Compactor{-1};
+
+    EXPECT_EQ(compact(compactor, "G21 G90 (metric) ; setup"), "G21G90");
+    EXPECT_EQ(
+        compact(compactor, "g01 x 1.500 y-0.250 f1500.0"), "G1X1.5Y-.25F1500");
+    EXPECT_EQ(compact(compactor, "  ; nothing here"), "");
+    EXPECT_EQ(compact(compactor, "(MSG,Change tool)"), "(MSG,Change tool)");
+    EXPECT_EQ(compact(compactor, " $H "), "$H");
+}
+
+TEST(Compactor, drops_repeated_modal_words)
+{
+    auto compactor = libsubtractive::gcode::Compactor{-1};
+
+    EXPECT_EQ(compact(compactor, "G1 X1 F100"), "G1X1F100");
+    EXPECT_EQ(compact(compactor, "G1 X2 F100"), "X2");
+    EXPECT_EQ(compact(compactor, "G0 Z5"), "G0Z5");
+    EXPECT_EQ(compact(compactor, "G93 G1 X3 F2"), "G93G1X3F2");
+    EXPECT_EQ(compact(compactor, "G1 X4 F2"), "X4F2");
+
+    compactor.reset();
+
+    EXPECT_EQ(compact(compactor, "G1 X5"), "G1X5");
+}
+
+TEST(Compactor, keeps_feed_across_unit_changes)
+{
+    auto compactor = libsubtractive::gcode::Compactor{-1};
+
+    EXPECT_EQ(compact(compactor, "G21 G1 X1 F100"), "G21G1X1F100");
+    EXPECT_EQ(compact(compactor, "G20 X2 F100"), "G20X2F100");
+    EXPECT_EQ(compact(compactor, "X3 F100"), "X3");
+    EXPECT_EQ(compact(compactor, "G21"), "G21");
+    EXPECT_EQ(compact(compactor, "X4 F100"), "X4F100");
+}
+
+TEST(Compactor, rounds_coordinates)
+{
+    auto compactor = libsubtractive::gcode::Compactor{3};
+
+    EXPECT_EQ(
+        compact(compactor, "G2 X1.23456 Y-0.0001 I0.0005 F120.25"),
+        "G2X1.235Y0I.001F120.25");
+
+    const auto& stats = compactor.statistics();
+
+    EXPECT_EQ(stats.lines_, 1u);
+    EXPECT_LT(stats.bytes_out_, stats.bytes_in_);
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
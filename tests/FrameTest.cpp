@@ -0,0 +1,206 @@
+#include <gtest/gtest.h>
+#include <zmq.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "libsubtractive/communication/zmq/zeromq_wrapper.hpp"
+
+// Counts every heap allocation made through operator new by this process
+std::atomic<std::size_t> allocations_{0};
+// Counts how many times a payload created by make_frame() was released
+std::atomic<std::size_t> releases_{0};
+
+void* operator new(std::size_t size)
+{
+    ++allocations_;
+
+    if (auto* output = std::malloc(size); nullptr != output) { return output; }
+
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+namespace
+{
+constexpr auto payload_size_ = std::size_t{4096};
+
+void release(void* data, void*)
+{
+    ++releases_;
+    std::free(data);
+}
+
+// Constructs a frame which owns a caller-supplied payload. If the payload is
+// ever copied the data pointer of the frame will no longer equal payload.
+auto make_frame(void*& payload) -> libsubtractive::zmq::Frame
+{
+    payload = std::malloc(payload_size_);
+    auto output = libsubtractive::zmq::Frame{};
+    zmq_msg_close(output);
+    zmq_msg_init_data(output, payload, payload_size_, release, nullptr);
+
+    return output;
+}
+
+class Frame : public ::testing::Test
+{
+protected:
+    void SetUp() override { releases_ = 0; }
+};
+}  // namespace
+
+TEST_F(Frame, move_constructor_transfers_payload)
+{
+    void* payload{nullptr};
+
+    {
+        auto original = make_frame(payload);
+        const auto before = allocations_.load();
+        const auto moved = libsubtractive::zmq::Frame{std::move(original)};
+
+        EXPECT_EQ(allocations_.load(), before);
+        EXPECT_EQ(moved.data(), payload);
+        EXPECT_EQ(moved.size(), payload_size_);
+        EXPECT_EQ(original.size(), 0u);
+    }
+
+    EXPECT_EQ(releases_.load(), 1u);
+}
+
+TEST_F(Frame, move_assignment_transfers_payload)
+{
+    void* payload{nullptr};
+
+    {
+        auto original = make_frame(payload);
+        auto target = libsubtractive::zmq::Frame{std::byte{0x01}};
+        const auto before = allocations_.load();
+        target = std::move(original);
+
+        EXPECT_EQ(allocations_.load(), before);
+        EXPECT_EQ(target.data(), payload);
+        EXPECT_EQ(target.size(), payload_size_);
+        EXPECT_EQ(original.size(), 0u);
+    }
+
+    EXPECT_EQ(releases_.load(), 1u);
+}
+
+TEST_F(Frame, copy_shares_payload)
+{
+    void* payload{nullptr};
+
+    {
+        const auto original = make_frame(payload);
+        const auto before = allocations_.load();
+        const auto copy = libsubtractive::zmq::Frame{original};
+
+        EXPECT_EQ(allocations_.load(), before);
+        EXPECT_EQ(original.data(), payload);
+        EXPECT_EQ(copy.data(), payload);
+    }
+
+    EXPECT_EQ(releases_.load(), 1u);
+}
+
+TEST_F(Frame, message_growth_does_not_copy_payloads)
+{
+    void* payload{nullptr};
+
+    {
+        auto message = libsubtractive::zmq::Message{};
+        message.emplace_back(make_frame(payload));
+
+        for (auto i = 0; i < 1000; ++i) { message.emplace_back(i); }
+
+        EXPECT_EQ(message.front().data(), payload);
+
+        const auto moved = std::move(message);
+
+        EXPECT_EQ(moved.front().data(), payload);
+    }
+
+    EXPECT_EQ(releases_.load(), 1u);
+}
+
+TEST_F(Frame, forward_shares_payloads)
+{
+    using namespace libsubtractive;
+
+    void* payload{nullptr};
+
+    {
+        auto message = zmq::Message::MakePush(
+            zmq::Message::Identity{std::byte{0x01}},
+            Command::ResponseReceived);
+        message.emplace_back(make_frame(payload));
+        const auto recipients = std::vector<zmq::Message::Identity>{
+            {std::byte{0x02}}, {std::byte{0x03}, std::byte{0x04}}};
+        auto forwarded = std::vector<zmq::Message>{};
+
+        for (const auto& id : recipients) {
+            forwarded.emplace_back(message.forward(id));
+        }
+
+        for (auto i = std::size_t{0}; i < recipients.size(); ++i) {
+            const auto& push = forwarded.at(i);
+
+            EXPECT_EQ(push.identity(), recipients.at(i));
+            EXPECT_EQ(push.type(), Command::ResponseReceived);
+            ASSERT_EQ(push.arg_count(), 1u);
+            EXPECT_EQ(push.arg(0).data(), payload);
+        }
+    }
+
+    EXPECT_EQ(releases_.load(), 1u);
+}
+
+TEST_F(Frame, inproc_handoff_does_not_copy_payloads)
+{
+    using namespace libsubtractive;
+
+    void* payload{nullptr};
+    const auto zeromq = zmq::Context{};
+    const auto endpoint = RandomEndpoint();
+
+    {
+        const auto receiver =
+            zeromq.Socket(ZMQ_PAIR, Direction::Bind, endpoint);
+        const auto sender =
+            zeromq.Socket(ZMQ_PAIR, Direction::Connect, endpoint);
+        auto message = zeromq.Command(Command::SendGcode);
+        message.emplace_back(make_frame(payload));
+
+        ASSERT_TRUE(sender.send(std::move(message)));
+
+        auto poll = zmq_pollitem_t{};
+        poll.socket = receiver;
+        poll.events = ZMQ_POLLIN;
+
+        ASSERT_EQ(zmq_poll(&poll, 1, 1000), 1);
+
+        auto received = zmq::Message{};
+
+        ASSERT_TRUE(receiver.receive(received));
+        ASSERT_EQ(received.arg_count(), 1u);
+        EXPECT_EQ(received.arg(0).data(), payload);
+    }
+
+    EXPECT_EQ(releases_.load(), 1u);
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
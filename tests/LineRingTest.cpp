@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "libsubtractive/communication/linering.hpp"
+
+// Counts every heap allocation made through operator new by this process
+std::atomic<std::size_t> allocations_{0};
+
+void* operator new(std::size_t size)
+{
+    ++allocations_;
+
+    if (auto* output = std::malloc(size); nullptr != output) { return output; }
+
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+namespace
+{
+using Ring = libsubtractive::LineRing<int>;
+
+constexpr auto width_ = std::size_t{127};
+}  // namespace
+
+TEST(LineRing, order)
+{
+    auto ring = Ring{4, width_};
+
+    EXPECT_TRUE(ring.empty());
+    EXPECT_TRUE(ring.push_back(1, "G0 X1"));
+    EXPECT_TRUE(ring.push_back(2, "G0 X2", true));
+    EXPECT_TRUE(ring.push_front(0, "?"));
+    ASSERT_EQ(ring.size(), 3u);
+    EXPECT_EQ(ring.front().first, 0);
+    EXPECT_EQ(ring.front().second, "?");
+    EXPECT_EQ(ring.back().first, 2);
+    EXPECT_EQ(ring.back().second, "G0 X2\n");
+
+    ring.pop_front();
+    EXPECT_EQ(ring.front().first, 1);
+    EXPECT_EQ(ring.front().second, "G0 X1");
+
+    ring.clear();
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(LineRing, width)
+{
+    auto ring = Ring{4, 4};
+
+    EXPECT_TRUE(ring.push_back(1, "1234"));
+    EXPECT_FALSE(ring.push_back(2, "1234", true));
+    EXPECT_FALSE(ring.push_front(2, "12345"));
+    EXPECT_EQ(ring.size(), 1u);
+
+    ring.reserve(8);
+    EXPECT_EQ(ring.width(), 8u);
+    EXPECT_EQ(ring.front().second, "1234");
+    EXPECT_TRUE(ring.push_back(2, "1234", true));
+    EXPECT_EQ(ring.back().second, "1234\n");
+
+    ring.reserve(2);
+    EXPECT_EQ(ring.width(), 8u);
+}
+
+TEST(LineRing, growth)
+{
+    auto ring = Ring{3, width_};
+
+    EXPECT_EQ(ring.capacity(), 4u);
+
+    // NOTE start in the middle so the queued lines wrap around
+    ring.push_back(-1, "");
+    ring.push_back(-1, "");
+    ring.pop_front();
+    ring.pop_front();
+
+    for (auto i = 0; i < 10; ++i) {
+        EXPECT_TRUE(ring.push_back(i, std::to_string(i)));
+    }
+
+    EXPECT_EQ(ring.capacity(), 16u);
+
+    for (auto i = 0; i < 10; ++i) {
+        EXPECT_EQ(ring.front().first, i);
+        EXPECT_EQ(ring.front().second, std::to_string(i));
+        ring.pop_front();
+    }
+}
+
+TEST(LineRing, erase_if)
+{
+    auto ring = Ring{8, width_};
+    ring.push_back(0, "a");
+    ring.push_back(1, "b");
+    ring.push_back(2, "c");
+    ring.push_front(3, "d");
+    ring.push_front(4, "e");
+
+    ring.erase_if([](const int header) { return 0 == (header % 2); });
+
+    ASSERT_EQ(ring.size(), 2u);
+    EXPECT_EQ(ring.front().second, "d");
+    ring.pop_front();
+    EXPECT_EQ(ring.front().second, "b");
+}
+
+// Mirrors how flow control streams a program: lines are queued, moved to the
+// outgoing queue when transmitted and removed when acknowledged, with status
+// requests jumping the queue
+TEST(LineRing, streaming_does_not_allocate)
+{
+    auto incoming = Ring{512, width_};
+    auto outgoing = Ring{512, width_};
+    auto line = std::string{"G1 X100.125 Y-20.5 F1500"};
+    line.reserve(width_);
+    const auto before = allocations_.load();
+
+    for (auto i = 0; i < 100000; ++i) {
+        line.back() = static_cast<char>('0' + (i % 10));
+
+        ASSERT_TRUE(incoming.push_back(1, line, true));
+
+        if (0 == (i % 50)) { ASSERT_TRUE(incoming.push_front(0, "?")); }
+
+        while (4u < incoming.size()) {
+            const auto [header, bytes] = incoming.front();
+            ASSERT_TRUE(outgoing.push_back(header, bytes));
+            incoming.pop_front();
+        }
+
+        while (8u < outgoing.size()) { outgoing.pop_front(); }
+
+        if (0 == (i % 1000)) {
+            incoming.erase_if([](const int header) { return 0 == header; });
+        }
+    }
+
+    EXPECT_EQ(allocations_.load(), before);
+    EXPECT_EQ(outgoing.back().second.back(), '\n');
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "libsubtractive/log.hpp"
+
+namespace
+{
+namespace log = libsubtractive::log;
+
+auto text(const log::Record& record) -> std::string_view
+{
+    return {record.text_.data(), record.header_.size_};
+}
+}  // namespace
+
+TEST(Log, levels)
+{
+    log::level_.store(log::Level::Warning);
+
+    EXPECT_TRUE(log::enabled(log::Level::Error));
+    EXPECT_TRUE(log::enabled(log::Level::Warning));
+    EXPECT_FALSE(log::enabled(log::Level::Info));
+    EXPECT_FALSE(log::enabled(log::Level::Debug));
+    EXPECT_FALSE(log::enabled(log::Level::Off));
+
+    log::level_.store(log::Level::Off);
+
+    EXPECT_FALSE(log::enabled(log::Level::Error));
+
+    log::level_.store(log::Level::Info);
+}
+
+TEST(Log, format)
+{
+    auto record = log::Record{log::Level::Info};
+    record.append("Receive buffer for ");
+    record.append(std::string{"abc"});
+    record.append(": ");
+    record.append(std::size_t{128});
+    record.append(' ');
+    record.append(-1.5);
+    record.append(static_cast<std::uint8_t>(7));
+
+    EXPECT_EQ(text(record), "Receive buffer for abc: 128 -1.57");
+    EXPECT_EQ(record.header_.level_, log::Level::Info);
+    EXPECT_NE(record.header_.time_, 0u);
+}
+
+TEST(Log, truncation)
+{
+    auto record = log::Record{log::Level::Debug};
+    const auto line = std::string(log::Record::Capacity - 2u, 'x');
+    record.append(line);
+    record.append(12345);
+    record.append("abc");
+
+    EXPECT_EQ(record.header_.size_, log::Record::Capacity);
+    EXPECT_EQ(text(record).substr(line.size()), "ab");
+}
+
+TEST(Log, binary_file)
+{
+    auto path = std::string{"/tmp/ls-log-XXXXXX"};
+    const auto fd = ::mkstemp(path.data());
+    ASSERT_NE(fd, -1);
+    ::close(fd);
+
+    log::configure(log::Level::Info, path.c_str());
+    log::info("Device ", "ABC", " connected via: ", "/dev/ttyACM0");
+    log::debug("receive: ok");
+    log::warning("Dropped ", 3, " lines");
+    log::flush();
+    log::configure(log::Level::Info, nullptr);
+
+    auto file = std::ifstream{path, std::ios::binary};
+    const auto data = std::string{
+        std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    ::unlink(path.c_str());
+
+    ASSERT_GT(data.size(), 8u);
+    EXPECT_EQ(data.substr(0, 8u), "LSLOG01\n");
+
+    auto offset = std::size_t{8};
+    auto header = log::Record::Header{};
+    auto read = [&]() -> std::string {
+        std::memcpy(&header, data.data() + offset, sizeof(header));
+        offset += sizeof(header);
+        const auto output = data.substr(offset, header.size_);
+        offset += header.size_;
+
+        return output;
+    };
+
+    EXPECT_EQ(read(), "Device ABC connected via: /dev/ttyACM0");
+    EXPECT_EQ(header.level_, log::Level::Info);
+    EXPECT_EQ(read(), "Dropped 3 lines");
+    EXPECT_EQ(header.level_, log::Level::Warning);
+    EXPECT_EQ(offset, data.size());
+}
+
+TEST(Log, threads)
+{
+    constexpr auto threads = 4;
+    constexpr auto count = 500;
+    auto path = std::string{"/tmp/ls-log-XXXXXX"};
+    const auto fd = ::mkstemp(path.data());
+    ASSERT_NE(fd, -1);
+    ::close(fd);
+
+    log::configure(log::Level::Info, path.c_str());
+
+    {
+        auto workers = std::vector<std::thread>{};
+
+        for (auto t = 0; t < threads; ++t) {
+            workers.emplace_back([t]() {
+                for (auto i = 0; i < count; ++i) { log::info(t, ":", i); }
+            });
+        }
+
+        for (auto& worker : workers) { worker.join(); }
+    }
+
+    log::flush();
+    log::configure(log::Level::Info, nullptr);
+
+    auto file = std::ifstream{path, std::ios::binary};
+    const auto data = std::string{
+        std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    ::unlink(path.c_str());
+    auto next = std::vector<int>(threads, 0);
+    auto offset = std::size_t{8};
+
+    while (offset < data.size()) {
+        auto header = log::Record::Header{};
+        std::memcpy(&header, data.data() + offset, sizeof(header));
+        offset += sizeof(header);
+        const auto line = data.substr(offset, header.size_);
+        offset += header.size_;
+        const auto colon = line.find(':');
+        ASSERT_NE(colon, std::string::npos);
+        const auto t = std::stoi(line.substr(0, colon));
+        ASSERT_LT(t, threads);
+
+        // NOTE records of one thread are written in the order it logged them
+        EXPECT_EQ(std::stoi(line.substr(colon + 1u)), next.at(t)++);
+    }
+
+    for (const auto received : next) { EXPECT_EQ(received, count); }
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
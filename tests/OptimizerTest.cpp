@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "libsubtractive/gcode/optimizer.hpp"
+
+namespace
+{
+auto run(
+    libsubtractive::gcode::Optimizer& optimizer,
+    const std::vector<std::string>& lines) -> std::vector<std::string>
+{
+    auto output = std::vector<std::string>{};
+    auto line = std::string{};
+
+    for (const auto& in : lines) {
+        optimizer.push(in);
+
+        while (optimizer.next(line)) { output.emplace_back(line); }
+    }
+
+    optimizer.flush();
+
+    while (optimizer.next(line)) { output.emplace_back(line); }
+
+    return output;
+}
+}  // namespace
+
+TEST(Optimizer, merges_collinear_moves)
+{
+    auto optimizer = libsubtractive::gcode::Optimizer{0.001};
+    const auto output = run(
+        optimizer,
+        {"G90 G17", "G0 X0 Y0 Z0", "G1 X1 F100", "G1 X2", "X3", "X4 Y1"});
+
+    ASSERT_EQ(output.size(), 4u);
+    EXPECT_EQ(output.at(0), "G90 G17");
+    EXPECT_EQ(output.at(1), "G0 X0 Y0 Z0");
+    EXPECT_EQ(output.at(2), "G1X3F100");
+    EXPECT_EQ(output.at(3), "G1X4Y1");
+    EXPECT_TRUE(optimizer.empty());
+    EXPECT_EQ(optimizer.statistics().lines_in_, 6u);
+    EXPECT_EQ(optimizer.statistics().lines_out_, 4u);
+    EXPECT_EQ(optimizer.statistics().lines_, 1u);
+}
+
+TEST(Optimizer, preserves_reversals)
+{
+    auto optimizer = libsubtractive::gcode::Optimizer{0.001};
+    const auto output = run(
+        optimizer, {"G90 G17", "G0 X0 Y0 Z0", "G1 X2 F100", "X1", "X3"});
+
+    ASSERT_EQ(output.size(), 5u);
+    EXPECT_EQ(output.at(2), "G1X2F100");
+    EXPECT_EQ(output.at(3), "G1X1");
+    EXPECT_EQ(output.at(4), "G1X3");
+}
+
+TEST(Optimizer, fits_arcs)
+{
+    auto optimizer = libsubtractive::gcode::Optimizer{0.01};
+    auto lines = std::vector<std::string>{"G90 G17", "G0 X10 Y0 Z0"};
+
+    for (auto i = 1; i <= 45; ++i) {
+        const auto angle = i * 3.14159265358979323846 / 90.0;
+        lines.emplace_back(
+            "G1 X" + std::to_string(10.0 * std::cos(angle)) + " Y" +
+            std::to_string(10.0 * std::sin(angle)) + " F500");
+    }
+
+    const auto output = run(optimizer, lines);
+
+    ASSERT_EQ(output.size(), 3u);
+    EXPECT_EQ(output.at(2), "G3X0Y10I-10J0F500");
+    EXPECT_EQ(optimizer.statistics().arcs_, 1u);
+}
+
+TEST(Optimizer, passes_through_unknown_state)
+{
+    auto optimizer = libsubtractive::gcode::Optimizer{0.001};
+    const auto output = run(
+        optimizer,
+        {"G1 X1 F100",
+         "G1 X2",
+         "G90 G0 X0 Y0 Z0",
+         "G1 X1",
+         "G91 X1",
+         "X1",
+         "$H",
+         "G90 G1 X5",
+         "G92 X0",
+         "G1 X1",
+         "G1 X2"});
+
+    ASSERT_EQ(output.size(), 11u);
+    EXPECT_EQ(output.at(3), "G1X1");
+    EXPECT_EQ(output.at(4), "G91 X1");
+    EXPECT_EQ(output.at(9), "G1 X1");
+    EXPECT_EQ(output.at(10), "G1 X2");
+}
+
+TEST(Optimizer, restores_motion_mode)
+{
+    auto optimizer = libsubtractive::gcode::Optimizer{0.001};
+    const auto output = run(
+        optimizer,
+        {"G90 G17",
+         "G0 X0 Y0 Z0",
+         "G1 X1 F100",
+         "G2 X2 Y1 I1 J0",
+         "X3 Y0 I0 J-1",
+         "G1 X4",
+         "X5",
+         "M5",
+         "Y1"});
+
+    ASSERT_EQ(output.size(), 8u);
+    EXPECT_EQ(output.at(4), "X3 Y0 I0 J-1");
+    EXPECT_EQ(output.at(5), "G1X5");
+    EXPECT_EQ(output.at(6), "M5");
+    EXPECT_EQ(output.at(7), "G1Y1");
+}
+
+TEST(Optimizer, non_modal_axis_commands_after_arcs)
+{
+    auto optimizer = libsubtractive::gcode::Optimizer{0.01};
+    auto lines = std::vector<std::string>{"G90 G17", "G0 X10 Y0 Z0"};
+
+    for (auto i = 1; i <= 45; ++i) {
+        const auto angle = i * 3.14159265358979323846 / 90.0;
+        lines.emplace_back(
+            "G1 X" + std::to_string(10.0 * std::cos(angle)) + " Y" +
+            std::to_string(10.0 * std::sin(angle)) + " F500");
+    }
+
+    lines.emplace_back("G91 G28 Z0");
+    lines.emplace_back("G90 X0 Y0 Z0");
+
+    const auto output = run(optimizer, lines);
+
+    ASSERT_EQ(output.size(), 5u);
+    EXPECT_EQ(output.at(2), "G3X0Y10I-10J0F500");
+    EXPECT_EQ(output.at(3), "G91 G28 Z0");
+    EXPECT_EQ(output.at(4), "G1G90 X0 Y0 Z0");
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
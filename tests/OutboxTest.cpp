@@ -0,0 +1,194 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "libsubtractive/communication/zmq/zeromq_wrapper.hpp"
+#include "libsubtractive/outbox.hpp"
+
+namespace
+{
+using libsubtractive::Command;
+using libsubtractive::Outbox;
+using libsubtractive::zmq::Message;
+
+const auto subscriber_ = Message::Identity{std::byte{0x2a}};
+
+// Records the messages an Outbox sends while error is 0, otherwise fails
+// every send with error
+struct Recipient {
+    int error_{0};
+    std::vector<Message> received_{};
+
+    auto send() -> Outbox::Send
+    {
+        return [this](Message& message) -> int {
+            if (0 != error_) { return error_; }
+
+            received_.emplace_back(std::move(message));
+
+            return 0;
+        };
+    }
+};
+
+auto make(const Command type, const std::string_view machine, const int value)
+    -> Message
+{
+    auto output = Message::MakePush(subscriber_, type);
+    output.emplace_back(machine.data(), machine.size());
+    output.emplace_back(value);
+
+    return output;
+}
+
+auto value(const Message& message) -> int { return message.arg(1).as<int>(); }
+}  // namespace
+
+TEST(Outbox, sends_immediately)
+{
+    auto recipient = Recipient{};
+    auto outbox = Outbox{subscriber_, recipient.send(), 4};
+
+    EXPECT_EQ(
+        outbox.send(make(Command::ResponseReceived, "A", 1)),
+        Outbox::State::Empty);
+    EXPECT_EQ(
+        outbox.send(make(Command::StatusReport, "A", 2), true),
+        Outbox::State::Empty);
+    ASSERT_EQ(recipient.received_.size(), 2u);
+    EXPECT_EQ(value(recipient.received_.at(0)), 1);
+    EXPECT_EQ(value(recipient.received_.at(1)), 2);
+    EXPECT_EQ(recipient.received_.at(0).identity(), subscriber_);
+    EXPECT_EQ(outbox.size(), 0u);
+}
+
+TEST(Outbox, keeps_order_while_waiting)
+{
+    auto recipient = Recipient{EAGAIN};
+    auto outbox = Outbox{subscriber_, recipient.send(), 4};
+
+    for (auto i = 0; i < 3; ++i) {
+        EXPECT_EQ(
+            outbox.send(make(Command::ResponseReceived, "A", i)),
+            Outbox::State::Waiting);
+    }
+
+    EXPECT_EQ(outbox.size(), 3u);
+
+    recipient.error_ = 0;
+
+    EXPECT_EQ(outbox.flush(), Outbox::State::Empty);
+    ASSERT_EQ(recipient.received_.size(), 3u);
+
+    for (auto i = 0; i < 3; ++i) {
+        EXPECT_EQ(value(recipient.received_.at(i)), i);
+    }
+}
+
+TEST(Outbox, conflates_latest_per_machine_and_type)
+{
+    auto recipient = Recipient{EAGAIN};
+    auto outbox = Outbox{subscriber_, recipient.send(), 4};
+
+    for (auto i = 0; i < 100; ++i) {
+        outbox.send(make(Command::StatusReport, "A", i), true);
+        outbox.send(make(Command::StatusReport, "B", 1000 + i), true);
+        outbox.send(make(Command::ProgramProgress, "A", 2000 + i), true);
+    }
+
+    outbox.send(make(Command::ResponseReceived, "A", -1));
+
+    EXPECT_EQ(outbox.size(), 4u);
+    EXPECT_EQ(outbox.dropped(), 0u);
+
+    recipient.error_ = 0;
+
+    EXPECT_EQ(outbox.flush(), Outbox::State::Empty);
+    ASSERT_EQ(recipient.received_.size(), 4u);
+    // NOTE ordered messages are delivered before conflated ones
+    EXPECT_EQ(value(recipient.received_.at(0)), -1);
+
+    auto latest = std::vector<int>{};
+
+    for (auto i = std::size_t{1}; i < 4u; ++i) {
+        latest.emplace_back(value(recipient.received_.at(i)));
+    }
+
+    std::sort(latest.begin(), latest.end());
+
+    EXPECT_EQ(latest, (std::vector<int>{99, 1099, 2099}));
+}
+
+TEST(Outbox, reports_dropped_messages)
+{
+    auto recipient = Recipient{EAGAIN};
+    auto outbox = Outbox{subscriber_, recipient.send(), 3};
+
+    for (auto i = 0; i < 8; ++i) {
+        outbox.send(make(Command::ResponseReceived, "A", i));
+    }
+
+    EXPECT_EQ(outbox.size(), 3u);
+    EXPECT_EQ(outbox.dropped(), 5u);
+
+    recipient.error_ = 0;
+
+    EXPECT_EQ(outbox.flush(), Outbox::State::Empty);
+    ASSERT_EQ(recipient.received_.size(), 4u);
+
+    for (auto i = 0; i < 3; ++i) {
+        EXPECT_EQ(value(recipient.received_.at(i)), i);
+    }
+
+    const auto& notice = recipient.received_.at(3);
+
+    EXPECT_EQ(notice.identity(), subscriber_);
+    EXPECT_EQ(notice.type(), Command::EventsDropped);
+    ASSERT_EQ(notice.arg_count(), 1u);
+    EXPECT_EQ(notice.arg(0).as<std::uint64_t>(), 5u);
+
+    EXPECT_EQ(
+        outbox.send(make(Command::ResponseReceived, "A", 8)),
+        Outbox::State::Empty);
+    EXPECT_EQ(recipient.received_.size(), 5u);
+}
+
+TEST(Outbox, notice_precedes_later_messages)
+{
+    auto recipient = Recipient{EAGAIN};
+    auto outbox = Outbox{subscriber_, recipient.send(), 2};
+
+    for (auto i = 0; i < 3; ++i) {
+        outbox.send(make(Command::ResponseReceived, "A", i));
+    }
+
+    recipient.error_ = 0;
+    outbox.send(make(Command::ResponseReceived, "A", 3));
+
+    ASSERT_EQ(recipient.received_.size(), 4u);
+    EXPECT_EQ(value(recipient.received_.at(0)), 0);
+    EXPECT_EQ(value(recipient.received_.at(1)), 1);
+    EXPECT_EQ(recipient.received_.at(2).type(), Command::EventsDropped);
+    EXPECT_EQ(value(recipient.received_.at(3)), 3);
+}
+
+TEST(Outbox, unreachable)
+{
+    auto recipient = Recipient{EHOSTUNREACH};
+    auto outbox = Outbox{subscriber_, recipient.send(), 4};
+
+    EXPECT_EQ(
+        outbox.send(make(Command::ResponseReceived, "A", 0)),
+        Outbox::State::Unreachable);
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
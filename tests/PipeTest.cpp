@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include <poll.h>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+
+#include "libsubtractive/communication/pipe.hpp"
+#include "libsubtractive/communication/zmq/zeromq_wrapper.hpp"
+
+namespace
+{
+using Pipe = libsubtractive::Pipe;
+using Ring = libsubtractive::Ring;
+
+auto make_message(const std::uint64_t value) -> libsubtractive::zmq::Message
+{
+    auto output = libsubtractive::zmq::Message{};
+    output.emplace_back(value);
+
+    return output;
+}
+
+auto readable(const Pipe& pipe) noexcept -> bool
+{
+    auto item = pollfd{pipe.fd(), POLLIN, 0};
+
+    return 1 == ::poll(&item, 1, 0);
+}
+}  // namespace
+
+TEST(Ring, order_and_capacity)
+{
+    auto ring = Ring{3};
+    auto message = libsubtractive::zmq::Message{};
+
+    EXPECT_FALSE(ring.pop(message));
+
+    for (auto pass = std::uint64_t{0}; pass < 10u; ++pass) {
+        EXPECT_EQ(ring.push(make_message(pass * 4u)), Ring::Push::WasEmpty);
+
+        for (auto i = std::uint64_t{1}; i < 4u; ++i) {
+            const auto value = pass * 4u + i;
+            EXPECT_EQ(ring.push(make_message(value)), Ring::Push::Queued);
+        }
+
+        EXPECT_EQ(ring.push(make_message(0)), Ring::Push::Full);
+
+        for (auto i = std::uint64_t{0}; i < 4u; ++i) {
+            ASSERT_TRUE(ring.pop(message));
+            ASSERT_EQ(message.size(), 1u);
+            EXPECT_EQ(message.front().as<std::uint64_t>(), pass * 4u + i);
+        }
+
+        EXPECT_FALSE(ring.pop(message));
+    }
+}
+
+TEST(Pipe, wake_up)
+{
+    auto [left, right] = Pipe::Pair(16);
+    auto message = libsubtractive::zmq::Message{};
+
+    EXPECT_FALSE(readable(left));
+    EXPECT_FALSE(readable(right));
+
+    ASSERT_TRUE(left.send(make_message(1)));
+    ASSERT_TRUE(left.send(make_message(2)));
+    EXPECT_FALSE(readable(left));
+    EXPECT_TRUE(readable(right));
+
+    right.clear();
+    EXPECT_FALSE(readable(right));
+    ASSERT_TRUE(right.receive(message));
+    EXPECT_EQ(message.front().as<std::uint64_t>(), 1u);
+
+    right.wake();
+    EXPECT_TRUE(readable(right));
+    right.clear();
+    ASSERT_TRUE(right.receive(message));
+    EXPECT_EQ(message.front().as<std::uint64_t>(), 2u);
+    EXPECT_FALSE(right.receive(message));
+
+    ASSERT_TRUE(right.send(make_message(3)));
+    EXPECT_TRUE(readable(left));
+    EXPECT_FALSE(right.receive(message));
+    left.clear();
+    ASSERT_TRUE(left.receive(message));
+    EXPECT_EQ(message.front().as<std::uint64_t>(), 3u);
+}
+
+TEST(Pipe, threads)
+{
+    constexpr auto count = std::uint64_t{100000};
+    auto [producer, consumer] = Pipe::Pair(64);
+    auto thread = std::thread{[&, &sender = producer]() {
+        for (auto i = std::uint64_t{0}; i < count; ++i) {
+            sender.send(make_message(i));
+        }
+    }};
+    auto expected = std::uint64_t{0};
+    auto message = libsubtractive::zmq::Message{};
+
+    while (expected < count) {
+        auto item = pollfd{consumer.fd(), POLLIN, 0};
+
+        // NOTE a lost wake up would hang here, so give up after a second
+        ASSERT_EQ(::poll(&item, 1, 1000), 1);
+        consumer.clear();
+
+        while (consumer.receive(message)) {
+            ASSERT_EQ(message.front().as<std::uint64_t>(), expected);
+            ++expected;
+        }
+    }
+
+    thread.join();
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+
+#include "libsubtractive/communication/planner.hpp"
+
+using libsubtractive::Planner;
+
+TEST(Planner, full_report)
+{
+    auto planner = Planner{};
+    planner.resize(15);
+    planner.report(0);
+
+    EXPECT_TRUE(planner.full());
+    EXPECT_EQ(planner.size(), 15u);
+}
+
+TEST(Planner, free_blocks)
+{
+    auto planner = Planner{};
+    planner.resize(15);
+    planner.report(3);
+
+    EXPECT_FALSE(planner.full());
+}
+
+TEST(Planner, unknown_size)
+{
+    auto planner = Planner{};
+    planner.report(0);
+
+    EXPECT_FALSE(planner.full());
+}
+
+// A report taken before a planned line was acknowledged no longer holds
+// lines back, even if no further status report arrives
+TEST(Planner, stale_report)
+{
+    auto planner = Planner{};
+    planner.resize(15);
+    planner.report(0);
+    planner.expire();
+
+    EXPECT_FALSE(planner.full());
+
+    planner.report(0);
+
+    EXPECT_TRUE(planner.full());
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
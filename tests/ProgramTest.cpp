@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "libsubtractive/communication/zmq/zeromq_wrapper.hpp"
+#include "libsubtractive/gcode/program.hpp"
+
+namespace
+{
+using libsubtractive::gcode::Program;
+using libsubtractive::zmq::Frame;
+
+auto read(Program& program) -> std::vector<std::string>
+{
+    auto output = std::vector<std::string>{};
+    auto line = std::string_view{};
+
+    while (program.next(line)) { output.emplace_back(line); }
+
+    return output;
+}
+}  // namespace
+
+TEST(Program, short_buffer)
+{
+    const auto text = std::string_view{"G0 X0\r\nG1 X1 F100\n"};
+    auto program = Program::Buffer(Frame{text.data(), text.size()});
+
+    ASSERT_TRUE(program);
+    EXPECT_EQ(program->text(), text);
+    EXPECT_TRUE(program->identity().empty());
+
+    const auto lines = read(*program);
+
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_EQ(lines.at(0), "G0 X0");
+    EXPECT_EQ(lines.at(1), "G1 X1 F100");
+    EXPECT_EQ(program->line(), 2u);
+    EXPECT_EQ(program->offset(), text.size());
+}
+
+TEST(Program, long_buffer)
+{
+    auto text = std::string{};
+
+    for (auto i = 0; i < 100; ++i) {
+        text.append("G1 X").append(std::to_string(i)).append("\n");
+    }
+
+    auto program = Program::Buffer(Frame{text.data(), text.size()});
+
+    ASSERT_TRUE(program);
+    EXPECT_EQ(program->text(), text);
+
+    const auto lines = read(*program);
+
+    ASSERT_EQ(lines.size(), 100u);
+    EXPECT_EQ(lines.at(99), "G1 X99");
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "libsubtractive/registry.hpp"
+
+// Counts every heap allocation made through operator new by this process
+std::atomic<std::size_t> allocations_{0};
+
+void* operator new(std::size_t size)
+{
+    ++allocations_;
+
+    if (auto* output = std::malloc(size); nullptr != output) { return output; }
+
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+namespace
+{
+using Registry = libsubtractive::Registry<std::vector<int>>;
+}  // namespace
+
+TEST(Registry, intern)
+{
+    auto registry = Registry{};
+
+    EXPECT_EQ(registry.find("A"), Registry::Invalid);
+
+    const auto a = registry.intern("A");
+    const auto b = registry.intern(std::string{"B"});
+
+    EXPECT_EQ(a, 0u);
+    EXPECT_EQ(b, 1u);
+    EXPECT_EQ(registry.intern("A"), a);
+    EXPECT_EQ(registry.find("A"), a);
+    EXPECT_EQ(registry.find("B"), b);
+    EXPECT_EQ(registry.id(b), "B");
+    EXPECT_EQ(registry.size(), 2u);
+    EXPECT_TRUE(registry.get(a).empty());
+}
+
+TEST(Registry, stable_references)
+{
+    auto registry = Registry{};
+    const auto first = registry.intern("first");
+    auto& value = registry.get(first);
+    value.emplace_back(42);
+    const auto id = registry.id(first);
+
+    for (auto i = 0; i < 1000; ++i) { registry.intern(std::to_string(i)); }
+
+    EXPECT_EQ(&registry.get(first), &value);
+    EXPECT_EQ(registry.id(first).data(), id.data());
+    EXPECT_EQ(registry.get(first).at(0), 42);
+    EXPECT_EQ(registry.find("999"), 1000u);
+}
+
+TEST(Registry, lookup_does_not_allocate)
+{
+    auto registry = Registry{};
+
+    for (auto i = 0; i < 100; ++i) { registry.intern(std::to_string(i)); }
+
+    const auto key = std::string{"57"};
+    const auto before = allocations_.load();
+    const auto handle = registry.find(std::string_view{key});
+    const auto interned = registry.intern(std::string_view{key});
+
+    EXPECT_EQ(allocations_.load(), before);
+    EXPECT_EQ(handle, 57u);
+    EXPECT_EQ(interned, handle);
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "libsubtractive/gcode/resume.hpp"
+
+namespace
+{
+using Resume = libsubtractive::gcode::Resume;
+
+constexpr auto Key = libsubtractive::gcode::Cache::Key{};
+
+// Feeds every line of text to the index the way flow control does
+auto stream(Resume& resume, const std::string_view text) -> void
+{
+    auto offset = std::size_t{0};
+    auto number = std::size_t{0};
+
+    while (offset < text.size()) {
+        auto end = text.find('\n', offset);
+        end = (std::string_view::npos == end) ? text.size() : end + 1u;
+        resume.read(text.substr(offset, end - offset), ++number, end);
+        offset = end;
+    }
+}
+}  // namespace
+
+TEST(Resume, modal_state)
+{
+    const auto text = std::string{
+        "G20 G17 G90\n"
+        "G55\n"
+        "T2 S12000 M3 M8\n"
+        "G0 X1 Y2 Z0.5\n"
+        "G1 Z-0.1 F20\n"
+        "G91 X0.5\n"
+        "G1 Y1\n"};
+    auto resume = Resume{Key};
+    auto offset = std::size_t{0};
+    auto preamble = std::vector<std::string>{};
+
+    ASSERT_TRUE(resume.seek(text, 7, offset, preamble));
+    EXPECT_EQ(text.substr(offset), "G1 Y1\n");
+    ASSERT_EQ(preamble.size(), 8u);
+    EXPECT_EQ(preamble.at(0), "G20G17G55G90G94");
+    EXPECT_EQ(preamble.at(1), "T2");
+    EXPECT_EQ(preamble.at(2), "S12000M3");
+    EXPECT_EQ(preamble.at(3), "M8");
+    EXPECT_EQ(preamble.at(4), "G0Z.5");
+    EXPECT_EQ(preamble.at(5), "G0X1.5Y2");
+    EXPECT_EQ(preamble.at(6), "G1Z-.1F20");
+    EXPECT_EQ(preamble.at(7), "G91G1F20");
+}
+
+TEST(Resume, unknown_position)
+{
+    const auto text = std::string{
+        "G0 X1 Y1 Z1\n"
+        "G28\n"
+        "G0 Z2\n"
+        "G1 X3 F100\n"};
+    auto resume = Resume{Key};
+    auto offset = std::size_t{0};
+    auto preamble = std::vector<std::string>{};
+
+    ASSERT_TRUE(resume.seek(text, 4, offset, preamble));
+    ASSERT_EQ(preamble.size(), 3u);
+    EXPECT_EQ(preamble.at(0), "G21G17G54G90G94");
+    EXPECT_EQ(preamble.at(1), "G0Z2");
+    EXPECT_EQ(preamble.at(2), "G0");
+}
+
+TEST(Resume, checkpoints)
+{
+    auto text = std::string{"G21 G90\nG0 Z5\n"};
+    const auto lines = (3u * Resume::Interval) + 10u;
+
+    for (auto i = std::size_t{3}; i <= lines; ++i) {
+        text.append("G1 X").append(std::to_string(i)).append(" F500\n");
+    }
+
+    auto streamed = Resume{Key};
+    auto scanned = Resume{Key};
+    stream(streamed, text);
+
+    for (const auto line : {std::size_t{3}, Resume::Interval + 1u, lines}) {
+        auto offset1 = std::size_t{0};
+        auto offset2 = std::size_t{0};
+        auto preamble1 = std::vector<std::string>{};
+        auto preamble2 = std::vector<std::string>{};
+
+        ASSERT_TRUE(streamed.seek(text, line, offset1, preamble1));
+        ASSERT_TRUE(scanned.seek(text, line, offset2, preamble2));
+        EXPECT_EQ(offset1, offset2);
+        EXPECT_EQ(preamble1, preamble2);
+
+        const auto expected = "G1 X" + std::to_string(line) + " F500\n";
+        EXPECT_EQ(text.substr(offset1, expected.size()), expected);
+    }
+
+    auto offset = std::size_t{0};
+    auto preamble = std::vector<std::string>{};
+    EXPECT_FALSE(streamed.seek(text, lines + 1u, offset, preamble));
+    EXPECT_FALSE(streamed.seek(text, 0, offset, preamble));
+}
+
+TEST(Resume, saved_checkpoints)
+{
+    auto text = std::string{"G21 G90\nG0 Z5\n"};
+    const auto lines = (2u * Resume::Interval) + 10u;
+
+    for (auto i = std::size_t{3}; i <= lines; ++i) {
+        text.append("G1 X").append(std::to_string(i)).append(" F500\n");
+    }
+
+    auto streamed = Resume{Key};
+    stream(streamed, text);
+    auto saved = std::string{};
+    streamed.save(saved);
+    auto loaded = Resume{Key};
+
+    EXPECT_FALSE(loaded.load({}));
+    EXPECT_FALSE(loaded.load(std::string_view{saved}.substr(1)));
+    ASSERT_TRUE(loaded.load(saved));
+
+    auto offset1 = std::size_t{0};
+    auto preamble1 = std::vector<std::string>{};
+    ASSERT_TRUE(streamed.seek(text, lines, offset1, preamble1));
+
+    // NOTE a loaded index only reads the lines after its last checkpoint
+    auto blanked = text;
+    const auto checkpoint = text.find(
+        "G1 X" + std::to_string((2u * Resume::Interval) + 1u) + " ");
+    ASSERT_NE(checkpoint, std::string::npos);
+
+    for (auto i = std::size_t{0}; i < checkpoint; ++i) {
+        if ('\n' != blanked.at(i)) { blanked.at(i) = ';'; }
+    }
+
+    auto offset2 = std::size_t{0};
+    auto preamble2 = std::vector<std::string>{};
+    ASSERT_TRUE(loaded.seek(blanked, lines, offset2, preamble2));
+    EXPECT_EQ(offset1, offset2);
+    EXPECT_EQ(preamble1, preamble2);
+}
+
+TEST(Resume, program_end)
+{
+    const auto text = std::string{
+        "G91 G1 X1 F100 S1000 M3 M7\n"
+        "M30\n"
+        "G0 X0\n"};
+    auto resume = Resume{Key};
+    auto offset = std::size_t{0};
+    auto preamble = std::vector<std::string>{};
+
+    ASSERT_TRUE(resume.seek(text, 3, offset, preamble));
+    ASSERT_EQ(preamble.size(), 3u);
+    EXPECT_EQ(preamble.at(0), "G21G17G54G90G94");
+    EXPECT_EQ(preamble.at(1), "S1000");
+    EXPECT_EQ(preamble.at(2), "G1F100");
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
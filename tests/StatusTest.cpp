@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include "libsubtractive/libsubtractive.hpp"
+#include "libsubtractive/protocol/Status.hpp"
+
+using libsubtractive::grbl::parse_status;
+
+TEST(Status, rejects_other_lines)
+{
+    auto report = LS_status_report{};
+
+    EXPECT_FALSE(parse_status("ok", report));
+    EXPECT_FALSE(parse_status("[MSG:Caution: Unlocked]", report));
+    EXPECT_FALSE(parse_status("<Idle", report));
+}
+
+TEST(Status, decodes_all_fields)
+{
+    auto report = LS_status_report{};
+
+    ASSERT_TRUE(parse_status(
+        "<Hold:1|MPos:1.500,-2.250,3.000|FS:500,12000|WCO:1.000,1.000,1.000|"
+        "Ov:100,90,110|Bf:15,128|Pn:XPD|Ln:42>",
+        report));
+    EXPECT_EQ(report.state_, LS_STATE_HOLD);
+    EXPECT_EQ(report.substate_, 1u);
+    EXPECT_EQ(report.axes_, 3u);
+    EXPECT_DOUBLE_EQ(report.machine_position_[1], -2.25);
+    EXPECT_DOUBLE_EQ(report.work_position_[1], -3.25);
+    EXPECT_DOUBLE_EQ(report.feed_, 500.0);
+    EXPECT_DOUBLE_EQ(report.spindle_, 12000.0);
+    EXPECT_EQ(report.override_rapid_, 90u);
+    EXPECT_EQ(report.planner_available_, 15u);
+    EXPECT_EQ(report.rx_available_, 128u);
+    EXPECT_EQ(report.pins_, LS_PIN_X | LS_PIN_PROBE | LS_PIN_DOOR);
+    EXPECT_EQ(report.line_, 42u);
+    EXPECT_EQ(report.fields_, 0x1ffu);
+}
+
+TEST(Status, keeps_work_offset_between_reports)
+{
+    auto report = LS_status_report{};
+
+    ASSERT_TRUE(
+        parse_status("<Idle|WPos:0.000,0.000,0.000|WCO:2,3,4>", report));
+    ASSERT_TRUE(parse_status("<Run|WPos:1.000,1.000,1.000|FS:0,0>", report));
+    EXPECT_EQ(report.state_, LS_STATE_RUN);
+    EXPECT_DOUBLE_EQ(report.machine_position_[0], 3.0);
+    EXPECT_DOUBLE_EQ(report.machine_position_[2], 5.0);
+    EXPECT_EQ(report.pins_, 0u);
+    EXPECT_EQ(report.fields_ & LS_STATUS_BUFFER, 0u);
+    EXPECT_NE(report.fields_ & LS_STATUS_MPOS, 0u);
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}